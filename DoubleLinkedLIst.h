@@ -1,6 +1,7 @@
 #ifndef DOUBLELINKEDLIST_H
 #define DOUBLELINKEDLIST_H
 #include <stdexcept> // Para manejar excepciones
+#include <vector>
 #include "MPointer.h"
 
 // Definicion del nodo de la lista doblemente enlazada utilizando MPointers
@@ -15,6 +16,17 @@ public:
     Node(T value) : data(value), next(nullptr), prev(nullptr) {}  // Constructor con valor
 };
 
+// Aristas de Node<T> para el snapshot del heap (next y prev)
+template <typename T>
+struct MPointerSnapshotEdges<Node<T>> {
+    static constexpr bool known = true;
+    template <typename Visit>
+    static void forEach(const Node<T>& node, Visit visit) {
+        visit(node.next);
+        visit(node.prev);
+    }
+};
+
 
 // Lista doblemente enlazada
 template <typename T>
@@ -90,6 +102,36 @@ public:
         set(j, temp);
     }
 
+    // Copia los nodos a un bloque contiguo nuevo en el orden de la lista y suelta los nodos viejos,
+    // para que recorrer la lista vuelva a ser un acceso secuencial a memoria
+    void relayout() {
+        int n = size();
+        if (n == 0) {
+            return;
+        }
+
+        std::vector<MPointer<Node<T>>> block = MPointer<Node<T>>::NewBlock(n);
+        MPointer<Node<T>> current = head;
+        for (int i = 0; i < n; i++) {
+            block[i]->data = current->data;
+            block[i]->prev = (i > 0) ? block[i - 1] : nullptr;
+            block[i]->next = (i < n - 1) ? block[i + 1] : nullptr;
+            current = current->next;
+        }
+
+        // Romper los enlaces viejos en ambos sentidos para que el GC libere todos los nodos en el siguiente ciclo
+        current = head;
+        while (current != nullptr) {
+            MPointer<Node<T>> next = current->next;
+            current->next = nullptr;
+            current->prev = nullptr;
+            current = next;
+        }
+
+        head = block[0];
+        tail = block[n - 1];
+    }
+
     // Destructor para liberar la memoria de los nodos
     ~DoublyLinkedList() {
         MPointer<Node<T>> current = head;
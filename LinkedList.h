@@ -1,52 +1,103 @@
 #ifndef LINKEDLIST_H
 #define LINKEDLIST_H
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <unordered_map>
 
 template <typename T>
 class LinkedList {
-private:
+public:
     struct Node {
         T* address;   // Dirección de memoria
         int id;       // ID único para cada nodo
-        int refCount; // Contador de referencias
+        std::atomic<int> refCount; // Contador de referencias (compartido entre hilos)
         Node* next;   // Siguiente nodo en la lista
+        Node* prev;   // Nodo anterior (para eliminar en O(1) desde el índice)
+        int age;      // Recolecciones que ha sobrevivido (modo generacional)
+        uint64_t birthTime;   // Marca de MPointerTrace::now() al registrarse (histograma de vida del GC)
+        size_t birthCycle;    // Ciclos de recolección completados al registrarse
+
+        // Conteo sesgado: el hilo dueño cuenta sin instrucciones atómicas en biasedCount (solo él lo escribe)
+        std::atomic<uint64_t> biasedCount;  // Referencias del hilo dueño y sus escrituras (relaxed, sin RMW)
+        uint64_t owner;                // Hilo dueño (0 = sin dueño)
+        std::atomic<bool> merged;      // biasedCount ya se sumó a refCount (desde entonces todo va a refCount)
+        std::atomic<bool> mergeRequested;  // El nodo está en la cola del dueño (la cola tiene una referencia)
 
         // Constructor del nodo
-        Node(T* addr, int idVal) : address(addr), id(idVal), refCount(1), next(nullptr) {}
+        Node(T* addr, int idVal) : address(addr), id(idVal), refCount(1), next(nullptr), prev(nullptr), age(0),
+                                   birthTime(0), birthCycle(0), biasedCount(0), owner(0), merged(true), mergeRequested(false) {}
     };
 
+private:
     Node* head;        // Puntero al inicio de la lista
     int currentId;     // Contador para generar IDs únicos
+    std::unordered_map<int, Node*> index;  // Índice ID -> nodo para búsquedas en O(1)
+    Node* cursor;      // Próximo nodo de un recorrido por rebanadas (remove lo adelanta si lo borra)
 
 public:
-    LinkedList() : head(nullptr), currentId(0) {}
+    LinkedList() : head(nullptr), currentId(0), cursor(nullptr) {}
 
     // Encontrar un nodo por dirección
     Node* find(T* address);
 
     // Encontrar un nodo por ID
-    Node* findById(int id);
+    Node* findById(int id) const;
 
-    // Insertar una nueva dirección en la lista
-    void insert(T* address, int& newId);
+    // Insertar una nueva dirección en la lista (devuelve el nodo creado)
+    Node* insert(T* address, int& newId);
 
     // Eliminar un nodo por ID (sin liberar memoria)
     void remove(int id);
 
+    // Eliminar un nodo que ya se buscó (evita buscarlo otra vez en el índice)
+    void remove(Node* node);
+
+    // Eliminar en una sola pasada todos los nodos que cumplan el predicado (sin liberar memoria)
+    template <typename Predicate>
+    void removeIf(Predicate predicate);
+
     // Obtener la dirección asociada a un ID
-    T* getAddressById(int id);
+    T* getAddressById(int id) const;
+
+    // Actualizar la dirección asociada a un ID (cuando el objeto se mueve de lugar)
+    void setAddressById(int id, T* address);
+
+    // Recorrer todos los nodos de la lista
+    template <typename Func>
+    void forEach(Func func) const;
 
     // Obtener el refCount de un nodo por ID
-    int getRefCountById(int id);
+    int getRefCountById(int id) const;
 
     // Actualizar el refCount de un nodo por ID
     void setRefCountById(int id, int refCount);
 
+    // Recorrido reanudable: startCursor() lo pone en la cabeza y nextCursor() devuelve el nodo actual y avanza
+    // (nullptr al terminar). Entre llamadas se pueden borrar nodos; los insertados después no se visitan.
+    // Hay un solo cursor por lista: quien lo use debe ser el único recorrido de ese tipo en curso.
+    void startCursor() {
+        cursor = head;
+    }
+
+    Node* nextCursor() {
+        Node* node = cursor;
+        if (node != nullptr) {
+            cursor = node->next;
+        }
+        return node;
+    }
+
     int getCurrentId() const {
         return currentId;
     }
 
+    // Cantidad de nodos en la lista
+    size_t size() const {
+        return index.size();
+    }
+
     // Destructor (no elimina la memoria apuntada)
     ~LinkedList();
 };
@@ -64,55 +115,88 @@ typename LinkedList<T>::Node* LinkedList<T>::find(T* address) {
 }
 
 template <typename T>
-typename LinkedList<T>::Node* LinkedList<T>::findById(int id) {
-    Node* current = head;
-    while (current != nullptr) {
-        if (current->id == id) {
-            return current;
-        }
-        current = current->next;
-    }
-    return nullptr;
+typename LinkedList<T>::Node* LinkedList<T>::findById(int id) const {
+    auto it = index.find(id);
+    return (it != index.end()) ? it->second : nullptr;
 }
 
 template <typename T>
-void LinkedList<T>::insert(T* address, int& newId) {
+typename LinkedList<T>::Node* LinkedList<T>::insert(T* address, int& newId) {
     Node* newNode = new Node(address, ++currentId);
     newId = newNode->id;
     newNode->next = head;
+    if (head) {
+        head->prev = newNode;
+    }
     head = newNode;
+    index[newNode->id] = newNode;
+    return newNode;
 }
 
 template <typename T>
 void LinkedList<T>::remove(int id) {
-    Node* current = head;
-    Node* previous = nullptr;
+    Node* node = findById(id);
+    if (node != nullptr) {
+        remove(node);
+    }
+}
+
+template <typename T>
+void LinkedList<T>::remove(Node* node) {
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        head = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    if (cursor == node) {
+        cursor = node->next;
+    }
+    index.erase(node->id);
+    delete node;  // Solo elimina el nodo
+}
 
+template <typename T>
+template <typename Predicate>
+void LinkedList<T>::removeIf(Predicate predicate) {
+    Node* current = head;
     while (current != nullptr) {
-        if (current->id == id) {
-            if (previous) {
-                previous->next = current->next;
-            } else {
-                head = current->next;
-            }
-            delete current;  // Solo elimina el nodo
-            return;
+        Node* next = current->next;
+        if (predicate(*current)) {
+            remove(current);
         }
-        previous = current;
-        current = current->next;
+        current = next;
     }
 }
 
 template <typename T>
-T* LinkedList<T>::getAddressById(int id) {
+T* LinkedList<T>::getAddressById(int id) const {
     Node* node = findById(id);
     return (node != nullptr) ? node->address : nullptr;
 }
 
 template <typename T>
-int LinkedList<T>::getRefCountById(int id) {
+void LinkedList<T>::setAddressById(int id, T* address) {
+    Node* node = findById(id);
+    if (node) {
+        node->address = address;
+    }
+}
+
+template <typename T>
+template <typename Func>
+void LinkedList<T>::forEach(Func func) const {
+    for (Node* current = head; current != nullptr; current = current->next) {
+        func(*current);
+    }
+}
+
+template <typename T>
+int LinkedList<T>::getRefCountById(int id) const {
     Node* node = findById(id);
-    return (node != nullptr) ? node->refCount : 0;
+    return (node != nullptr) ? node->refCount.load() : 0;
 }
 
 template <typename T>
@@ -2,47 +2,112 @@
 #define MPOINTER_H
 
 #include "LinkedList.h"  // Incluye la lista enlazada
+#include "MPointerScope.h"  // Regiones para MPointers temporales
+#include "MPointerHeap.h"  // Chunks con mmap para los objetos del GC
+#include "MPointerWorkers.h"  // Hilos para el barrido en paralelo
+#include "MPointerRuntime.h"  // Límite del heap y recolección de emergencia
+#include "MPointerPolicy.h"  // Políticas de compilación (hilos, liberación, memoria)
+#include "MPointerTrace.h"  // Trazado de eventos en ring buffers por hilo
+#include "MPointerProbes.h"  // Probes USDT para perf/bpftrace
+#include "MPointerSnapshot.h"  // Snapshot binario del heap
+#include "MPointerProfiler.h"  // Muestreo de los sitios de New
+#include "MPointerRecorder.h"  // Grabación de New/copias/destrucciones para mpointer_replay
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include <chrono>
 #include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <new>
+#include <vector>
+#include <cassert>
 
-template <typename T>
+template <typename T, typename Policy = MPointerDefaultPolicy>
 class MPointerGC;
 
-template <typename T>
+template <typename T, typename Policy = MPointerDefaultPolicy>
 class MPointer {
 private:
-    T* ptr;  // Puntero de tipo T*
-    int id;  // ID único para cada MPointer
-    static MPointerGC<T>* gc;  // Puntero al Garbage Collector
+    using CountedBlock = MPointerCountedBlock<T, Policy>;
+
+    // Estado de un MPointer registrado en el GC
+    struct CollectedState {
+        int id = -1;  // ID único para cada MPointer
+        mutable unsigned epoch = 0;  // Época de reubicación del GC en la que se resolvió ptr
+        typename LinkedList<T>::Node* ctrl = nullptr;  // Nodo del registro (solo en los modos atómico y sesgado)
+#ifndef NDEBUG
+        MPointerScope* scope = nullptr;  // Región dueña del objeto (solo en debug, para detectar escapes)
+#endif
+    };
+
+    // Estado con conteo directo: el bloque con el contador y el objeto
+    struct CountedState {
+        CountedBlock* block = nullptr;
+    };
+
+    // Con MPointerAllocator::Region no hay nada que contar
+    struct RegionState {};
+
+    using State = std::conditional_t<Policy::collected, CollectedState,
+                                     std::conditional_t<Policy::counted, CountedState, RegionState>>;
+
+    mutable T* ptr;  // Puntero de tipo T* (caché de la dirección registrada para el ID)
+    State state;  // Lo que la política necesita además del puntero
+    static MPointerGC<T, Policy>* gc;  // Puntero al Garbage Collector (solo se instancia con Policy::collected)
+
+    static constexpr int REGION_ID = 0;  // ID de los objetos que no pasan por el registro (región o conteo directo)
 
-    friend class MPointerGC<T>;  // MPointerGC tiene acceso a los miembros privados
+    friend class MPointerGC<T, Policy>;  // MPointerGC tiene acceso a los miembros privados
+
+    // Toma una referencia sobre el objeto actual (GC, región o contador)
+    void acquire();
+
+    // Suelta la referencia sobre el objeto actual (GC, región o contador)
+    void release();
+
+    // Copia la referencia de otro MPointer (sin tomarla)
+    void copyFrom(const MPointer& other);
+
+    // Devuelve la dirección actual del objeto; si el GC compactó el heap se vuelve a resolver por ID
+    T* resolve() const;
 
 public:
-    static MPointer<T> New();
+    static MPointer New();
+
+    // Crea `count` objetos en memoria contigua (cada uno con su propio ID y refCount)
+    static std::vector<MPointer> NewBlock(size_t count);
+
     MPointer();
 
     T* get() const {
-        return ptr; //Poder retornar un atributo privado
+        return resolve(); //Poder retornar un atributo privado
     }
 
-    int getId() {
-        return id; //Poder retornar un atributo privado
+    int getId() const {
+        if constexpr (Policy::collected) {
+            return state.id; //Poder retornar un atributo privado
+        } else {
+            return ptr != nullptr ? REGION_ID : -1;
+        }
     }
 
     // Para shallow copy
-    MPointer(const MPointer<T>& other);
+    MPointer(const MPointer& other);
 
     // Sobrecarga del operador = para asignación de otro MPointer
-    MPointer<T>& operator=(const MPointer<T>& other);
+    MPointer& operator=(const MPointer& other);
 
     // Sobrecarga del operador = para nullptr (Lista doblemente enlazada)
-    MPointer<T>& operator=(std::nullptr_t) {
+    MPointer& operator=(std::nullptr_t) {
         if (ptr != nullptr) {
-            gc->DecreaseRefCount(id);  // Reduce el contador de referencias
+            release();  // Reduce el contador de referencias
             ptr = nullptr;  // Asigna nullptr
-            id = -1;        // Reinicia el ID
+            state = State();  // Reinicia el ID (y el resto del estado)
         }
         return *this;
     }
@@ -50,15 +115,15 @@ public:
     // Sobrecarga del operador = para asignación de un valor de tipo T (el mismo a lo interno de MPointer)
     template <typename U,
               typename = typename std::enable_if<std::is_same_v<T, U>>::type>
-    MPointer<T>& operator=(const U& value) {
+    MPointer& operator=(const U& value) {
         if (ptr) {
-            *ptr = value;  // Asigna el nuevo valor al objeto apuntado
+            *resolve() = value;  // Asigna el nuevo valor al objeto apuntado
         }
         return *this;
     }
 
     // Constructor que acepta nullptr
-    MPointer(std::nullptr_t) : ptr(nullptr), id(-1) {}
+    MPointer(std::nullptr_t) : ptr(nullptr) {}
 
 
     // Sobrecarga del operador != para nullptr (para lista doblemente enlazada)
@@ -68,7 +133,7 @@ public:
 
     // Sobrecarga del operador -> (para lista doblemente enlazada)
     T* operator->() const {
-        return ptr;
+        return resolve();
     }
 
     // Sobrecarga del operador == para nullptr (para lista doblemente enlazada)
@@ -84,139 +149,1514 @@ public:
 
 
 // Inicializa la clase singleton de MPointerGC
-template <typename T>
-MPointerGC<T>* MPointer<T>::gc = MPointerGC<T>::getInstance();
+template <typename T, typename Policy>
+MPointerGC<T, Policy>* MPointer<T, Policy>::gc = MPointerGC<T, Policy>::getInstance();
 
 // Metodo para crear un nuevo MPointer y guardar el espacio para el dato por guardar
-template <typename T>
-MPointer<T> MPointer<T>::New() {
-    MPointer<T> newPtr;
-    newPtr.ptr = new T();  // Asigna memoria para T en el heap
-    gc->Register(newPtr);  // Registra el nuevo MPointer en el GC
+template <typename T, typename Policy>
+MPointer<T, Policy> MPointer<T, Policy>::New() {
+    MPointerAllocationProfiler::sample<T>(sizeof(T));
+    MPointer newPtr;
+
+    if constexpr (Policy::regionOnly) {
+        MPointerScope* region = MPointerScope::active();
+        if (region == nullptr) {
+            throw std::logic_error("MPointerRegionPolicy: New() fuera de un MPointerScope");
+        }
+        newPtr.ptr = region->template create<T>();
+    } else if constexpr (Policy::counted) {
+        MPointerRuntime::getInstance().charge(sizeof(CountedBlock));  // Cuenta para el límite del heap
+        try {
+            newPtr.state.block = new CountedBlock();  // Contador y objeto en una sola reserva
+        } catch (...) {
+            MPointerRuntime::getInstance().credit(sizeof(CountedBlock));
+            throw;
+        }
+        newPtr.ptr = &newPtr.state.block->value;
+    } else {
+        // Dentro de un MPointerScope el objeto vive en la región y no pasa por el GC
+        MPointerScope* region = MPointerScope::active();
+        if (region != nullptr) {
+            newPtr.ptr = region->template create<T>();
+            newPtr.state.id = REGION_ID;
+#ifndef NDEBUG
+            newPtr.state.scope = region;
+            region->retainHandle();
+#endif
+            return newPtr;
+        }
+
+        void* memory = gc->AllocateObject();  // Asigna memoria para T (reciclada si hay en el pool)
+        try {
+            newPtr.ptr = new (memory) T();
+        } catch (...) {
+            gc->ReturnObject(memory);
+            throw;
+        }
+        MPointerTrace::trace(MPointerTraceKind::New, 0, sizeof(T));
+        MPOINTER_PROBE2(new, newPtr.ptr, sizeof(T));
+        newPtr.state.epoch = gc->getRelocationEpoch();
+        gc->Register(newPtr);  // Registra el nuevo MPointer en el GC
+        MPointerAllocationRecorder::record<T, Policy>(MPointerRecordKind::New, newPtr.state.id);
+    }
     return newPtr;  // Retorna el nuevo MPointer
 }
 
+// Metodo para crear varios MPointers cuyos objetos quedan uno junto al otro en memoria
+template <typename T, typename Policy>
+std::vector<MPointer<T, Policy>> MPointer<T, Policy>::NewBlock(size_t count) {
+    std::vector<MPointer> block;
+    block.reserve(count);
+
+    // En una región los objetos ya quedan contiguos por la bump allocation; con conteo directo cada
+    // objeto tiene su propio bloque
+    if (!Policy::collected || MPointerScope::active() != nullptr) {
+        for (size_t i = 0; i < count; i++) {
+            block.push_back(New());
+        }
+        return block;
+    }
+
+    if constexpr (Policy::collected) {
+        MPointerAllocationProfiler::sample<T>(count * sizeof(T), count);
+        std::vector<void*> memory = gc->AllocateObjects(count);
+        for (size_t i = 0; i < count; i++) {
+            MPointer newPtr;
+            try {
+                newPtr.ptr = new (memory[i]) T();
+            } catch (...) {
+                // Los ya construidos se sueltan con `block`; el resto de la memoria vuelve al GC
+                for (size_t rest = i; rest < count; rest++) {
+                    gc->ReturnObject(memory[rest]);
+                }
+                throw;
+            }
+            newPtr.state.epoch = gc->getRelocationEpoch();
+            gc->Register(newPtr);
+            MPointerAllocationRecorder::record<T, Policy>(MPointerRecordKind::New, newPtr.state.id);
+            block.push_back(newPtr);
+        }
+    }
+    return block;
+}
+
 //Constructor por default (no funciona, para que sea por el metodo new)
-template <typename T>
-MPointer<T>::MPointer() : ptr(nullptr), id(-1) {}
+template <typename T, typename Policy>
+MPointer<T, Policy>::MPointer() : ptr(nullptr) {}
+
+template <typename T, typename Policy>
+void MPointer<T, Policy>::copyFrom(const MPointer& other) {
+    ptr = other.resolve();  // Copia la dirección de memoria
+    state = other.state;    // Copia el ID (o el bloque del contador)
+}
 
 // Shallow Copy
-template <typename T>
-MPointer<T>::MPointer(const MPointer<T>& other) {
-    ptr = other.ptr;
-    id = other.id;
-    gc->Register(*this);  // Registra la copia en el GC
+template <typename T, typename Policy>
+MPointer<T, Policy>::MPointer(const MPointer& other) {
+    copyFrom(other);
+    acquire();  // Registra la copia en el GC
 }
 
 // Sobrecarga del operador "=" en caso de que sean 2 de tipo MPointer
-template <typename T>
-MPointer<T>& MPointer<T>::operator=(const MPointer<T>& other) {
+template <typename T, typename Policy>
+MPointer<T, Policy>& MPointer<T, Policy>::operator=(const MPointer& other) {
     if (this != &other) {
-        gc->DecreaseRefCount(id);  // Reduce el contador de referencias
-        ptr = other.ptr;           // Copia la dirección de memoria
-        id = other.id;             // Copia el ID
-        gc->Register(*this);       // Registra la nueva asignación
-    }
+        // Primero se toma la referencia nueva: `other` puede vivir dentro del objeto que se suelta
+        // (p = p->next), y en modo inmediato o con conteo directo soltarlo lo destruye en el acto
+        MPointer copy(other);
+        std::swap(ptr, copy.ptr);
+        std::swap(state, copy.state);
+    }                              // `copy` suelta el objeto anterior
     return *this;
 }
 
 // Sobrecarga del operador * para almacenar el puntero
-template <typename T>
-T& MPointer<T>::operator*() {
-    return *ptr;  // Devuelve una referencia al objeto apuntado
+template <typename T, typename Policy>
+T& MPointer<T, Policy>::operator*() {
+    return *resolve();  // Devuelve una referencia al objeto apuntado
 }
 
 // Sobrecarga del operador & para obtener el valor guardado
-template <typename T>
-T MPointer<T>::operator&() {
-    return *ptr;  // Devuelve el valor al que apunta ptr
+template <typename T, typename Policy>
+T MPointer<T, Policy>::operator&() {
+    return *resolve();  // Devuelve el valor al que apunta ptr
 }
 
 // Destructor de MPointer que llama a MPointerGC
-template <typename T>
-MPointer<T>::~MPointer() {
-    gc->DecreaseRefCount(id);  // Informa al GC para disminuir el contador de referencias
+template <typename T, typename Policy>
+MPointer<T, Policy>::~MPointer() {
+    release();  // Informa al GC para disminuir el contador de referencias
+}
+
+// Los objetos de una región no llevan refCount; en debug solo se cuentan los MPointers vivos
+template <typename T, typename Policy>
+void MPointer<T, Policy>::acquire() {
+    if constexpr (Policy::counted) {
+        if (state.block != nullptr) {
+            if constexpr (Policy::threading == MPointerThreading::MultiThreaded) {
+                state.block->refs.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                ++state.block->refs;
+            }
+        }
+    } else if constexpr (Policy::collected) {
+        if (state.id == REGION_ID) {
+#ifndef NDEBUG
+            state.scope->retainHandle();
+#endif
+            return;
+        }
+        if (state.ctrl != nullptr) {
+            gc->RetainNode(state.ctrl);  // Modos atómico/sesgado: sin lock ni búsqueda
+        } else if (state.id > 0) {
+            gc->IncreaseRefCount(state.id);  // La copia comparte el ID del original
+        }
+        if (state.id > 0) {
+            MPointerAllocationRecorder::record<T, Policy>(MPointerRecordKind::Copy, state.id);
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void MPointer<T, Policy>::release() {
+    if constexpr (Policy::counted) {
+        if (state.block != nullptr) {
+            bool last;
+            if constexpr (Policy::threading == MPointerThreading::MultiThreaded) {
+                last = state.block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            } else {
+                last = --state.block->refs == 0;
+            }
+            if (last) {
+                delete state.block;  // Última referencia: se destruye en el acto
+                MPointerRuntime::getInstance().credit(sizeof(CountedBlock));
+            }
+        }
+    } else if constexpr (Policy::collected) {
+        if (state.id == REGION_ID) {
+#ifndef NDEBUG
+            state.scope->releaseHandle();
+#endif
+            return;
+        }
+        if (state.id > 0) {
+            // Antes de soltar: así una copia hecha desde esta referencia siempre queda grabada antes
+            MPointerAllocationRecorder::record<T, Policy>(MPointerRecordKind::Destroy, state.id);
+        }
+        if (state.ctrl != nullptr) {
+            gc->ReleaseNode(state.ctrl);
+        } else if (state.id > 0) {
+            gc->DecreaseRefCount(state.id);  // Un MPointer nulo (ID -1) no tiene nada que soltar
+        }
+    }
+}
+
+// Los objetos de región nunca se mueven; los del GC solo cambian de dirección al compactar
+template <typename T, typename Policy>
+T* MPointer<T, Policy>::resolve() const {
+    if constexpr (Policy::collected) {
+        if (state.id > 0) {
+            unsigned current = gc->getRelocationEpoch();
+            if (state.epoch != current) {
+                ptr = gc->getAddress(state.id);
+                state.epoch = current;
+            }
+        }
+    }
+    return ptr;
 }
 
 
 // Clase GC
+// Cómo cuentan referencias las copias y destrucciones de MPointer<T>
+enum class RefCountMode {
+    Locked,    // gcMutex + búsqueda por ID en cada operación (comportamiento original)
+    Deferred,  // Logs por hilo que el GC aplica en cada ciclo
+    Atomic,    // Contador atómico en el nodo del registro
+    Biased     // El hilo dueño cuenta sin atómicos; los demás usan el contador atómico
+};
+
+// Cuándo despierta el hilo del GC. Un umbral en 0 queda desactivado.
+struct CollectionTriggers {
+    size_t bytesAllocated = 0;    // Bytes reservados desde la última recolección
+    size_t pendingZeroCount = 0;  // Objetos cuyo refCount llegó a 0 y esperan al GC
+    std::chrono::milliseconds maxLatency{1000};  // Tiempo máximo entre ciclos (0 = sin temporizador)
+    bool adaptive = false;  // Ajustar el intervalo según la tasa de reserva y la pausa medidas
+    std::chrono::milliseconds minInterval{10};   // Intervalo mínimo del modo adaptativo
+};
+
+// Quién ejecuta las recolecciones
+enum class CollectionMode {
+    Background,  // Hilo del GC que despierta por temporizador o umbrales (comportamiento original)
+    Manual,      // Sin hilo: solo collect() explícito o un umbral cruzado (se recolecta en el hilo que lo cruza)
+    Immediate    // Sin hilo: el objeto se destruye al soltar su última referencia (no sirve con conteo diferido)
+};
+
+// Resultado de MPointerGC::collect()
+struct CollectionStats {
+    size_t freed = 0;           // Objetos liberados
+    size_t bytesFreed = 0;      // sizeof(T) * freed
+    size_t remaining = 0;       // Objetos que siguen registrados
+    bool major = false;         // Se barrió toda la lista (no solo la nursery)
+    std::chrono::microseconds duration{0};
+};
+
+// Foto de las estadísticas de un MPointerGC (ver MPointerGC::stats())
+struct MPointerGCStats {
+    size_t liveObjects = 0;     // Objetos registrados sin liberar, incluida la basura sin barrer (= nodos del registro)
+    size_t liveBytes = 0;       // liveObjects * sizeof(T)
+    size_t allocations = 0;     // Objetos registrados desde el inicio
+    size_t frees = 0;           // Objetos liberados desde el inicio
+    size_t allocatorCalls = 0;  // Reservas que llegaron al slab / operator new
+    size_t recycleHits = 0;     // Reservas servidas por el pool de reciclaje
+    size_t collections = 0;
+    size_t lastCollectionMicros = 0;
+    size_t lastCollectionFreed = 0;
+    size_t totalPauseMicros = 0;
+    size_t maxPauseMicros = 0;
+    std::vector<size_t> pauseHistogram;  // El bucket k cuenta las pausas de menos de 2^k microsegundos
+    // Vida de los objetos liberados, de New() a su liberación (mismo formato de buckets):
+    std::vector<size_t> lifetimeHistogram;  // En microsegundos (con setLifetimeTiming(true))
+    std::vector<size_t> survivedHistogram;  // En ciclos de recolección sobrevividos
+};
+
+// Objeto vivo que recibe el callback de MPointerGC::forEachLive
 template <typename T>
+struct MPointerLiveObject {
+    int id;
+    const T* address;  // Válida durante todo el recorrido (el objeto no se destruye mientras tanto)
+    int refCount;      // Incluye las referencias sesgadas que aún no se juntaron
+    size_t size;
+};
+
+template <typename T, typename Policy>
 class MPointerGC {
+    static_assert(Policy::collected, "MPointerGC solo se usa con MPointerReclamation::Collector");
+
+public:
+    using RegistryNode = typename LinkedList<T>::Node;
+
 private:
     LinkedList<T> memoryList;  // Lista enlazada que guarda direcciones de memoria
-    static MPointerGC<T>* instance;  // Singleton para la instancia de GC
+    static MPointerGC<T, Policy>* instance;  // Singleton para la instancia de GC
     static std::mutex gcMutex;  // Mutex para sincronización del thread
     std::thread gcThread;  // Hilo para ejecutar la limpieza periódica
-    bool running = true;  // Controla si el hilo de limpieza sigue ejecutándose
+    std::mutex threadMutex;  // Serializa los cambios de modo (arrancar o detener gcThread)
+    CollectionMode collectionMode = CollectionMode::Background;  // Protegido por threadMutex
+    std::atomic<bool> manual{false};  // Copia de collectionMode para el camino de los umbrales
+    std::atomic<bool> immediate{false};  // Copia de collectionMode para el camino de los decrementos
+
+    // Modo inmediato: IDs que llegaron a 0 mientras este hilo ya estaba liberando otro objeto
+    static inline thread_local std::vector<int> pendingReclaims;
+    static inline thread_local bool reclaiming = false;
+    bool running = true;  // Controla si el hilo de limpieza sigue ejecutándose (protegido por triggerMutex)
+    std::mutex collectMutex;  // Un solo ciclo de limpieza o compactación a la vez
+    std::atomic<unsigned> relocationEpoch{0};  // Cambia cada vez que la compactación mueve objetos
+
+    // Los objetos pequeños viven en un slab sobre chunks del MPointerHeap; los grandes usan operator new
+    static constexpr bool USE_SLAB = sizeof(T) <= MPointerSlab::MAX_OBJECT_SIZE;
+    std::unique_ptr<MPointerSlab> slab = std::make_unique<MPointerSlab>(sizeof(T), alignof(T));
+
+    // Pool de reciclaje: objetos ya destruidos cuya memoria se reutiliza en el siguiente New()
+    std::mutex poolMutex;  // Protege el pool y el slab (independiente de gcMutex)
+    std::vector<void*> recyclePool;  // Memoria sin objeto vivo lista para reutilizar
+    size_t recycleCapacity = 0;  // Máximo de objetos en el pool (0 = reciclaje desactivado)
+    size_t reusedSinceTrim = 0;  // Objetos tomados del pool desde el último recorte (high-water mark)
+    std::atomic<size_t> allocatorCalls{0};  // Veces que se pidió memoria al allocator
+    std::atomic<size_t> recycleHits{0};  // Veces que New() reutilizó memoria del pool
+
+    // Modo generacional: los objetos nuevos van a la nursery, que se revisa en cada ciclo;
+    // los que sobreviven `promotionAge` ciclos pasan a la generación vieja, que solo se barre cada `majorInterval` ciclos
+    bool generational = false;
+    int promotionAge = 2;
+    int majorInterval = 10;
+    std::vector<int> nursery;  // IDs de los objetos jóvenes (protegido por gcMutex)
+    size_t minorCollections = 0;
+    size_t majorCollections = 0;
+    size_t promotedObjects = 0;
+
+    // Conteo diferido (estilo Levanoni-Petrank): las copias y destrucciones de MPointers se anotan en un log
+    // por hilo sin tocar gcMutex; el GC los junta al inicio de cada ciclo. Los incrementos se aplican en el
+    // mismo ciclo y los decrementos en el siguiente, así un incremento que todavía no se recogió nunca
+    // llega tarde respecto al decremento que dejaría el refCount en 0.
+    struct RefCountLog {
+        std::mutex logMutex;  // Solo hay contención cuando el GC recoge el log
+        std::vector<std::pair<int, int>> entries;  // (ID, +1 / -1)
+        bool signalled = false;  // Ya se avisó al GC que el log pasó el umbral (se limpia al recogerlo)
+    };
+
+    // Dueño del log del hilo; al terminar el hilo sus entradas pendientes pasan al GC
+    struct LogHolder {
+        RefCountLog* log = nullptr;
+        ~LogHolder() {
+            if (log) {
+                MPointerGC<T, Policy>::getInstance()->retireLog(log);
+            }
+        }
+    };
+
+    static inline thread_local LogHolder localLog;
+    std::atomic<RefCountMode> refCountMode{RefCountMode::Locked};
+    std::mutex logsMutex;  // Protege logs y orphanEntries
+    std::vector<RefCountLog*> logs;  // Logs de todos los hilos vivos
+    std::vector<std::pair<int, int>> orphanEntries;  // Entradas de hilos que ya terminaron
+    std::unordered_map<int, int> heldDecrements;  // Decrementos recogidos en el ciclo anterior
+
+    // Entradas de un log que despiertan al GC para que lo recoja (8 bytes por entrada). Si el log llega al
+    // doble sin que el GC lo haya recogido (modo manual o GC atrasado), el propio hilo aplica los logs.
+    static constexpr size_t LOG_COLLECT_ENTRIES = 1 << 16;
+
+    // Anota un cambio de refCount en el log del hilo actual. Un cambio sobre el mismo ID que la entrada
+    // anterior se suma a ella (y la quita si quedan en 0): copiar y soltar un temporal no hace crecer el log.
+    // Quitar un +1 junto con su -1 baja por igual los incrementos y los decrementos pendientes.
+    void logRefCount(int id, int delta) {
+        if (localLog.log == nullptr) {
+            localLog.log = new RefCountLog();
+            std::lock_guard<std::mutex> lock(logsMutex);
+            logs.push_back(localLog.log);
+        }
+        bool signal = false;
+        bool drain = false;
+        {
+            std::lock_guard<std::mutex> lock(localLog.log->logMutex);
+            std::vector<std::pair<int, int>>& entries = localLog.log->entries;
+            if (!entries.empty() && entries.back().first == id) {
+                entries.back().second += delta;
+                if (entries.back().second == 0) {
+                    entries.pop_back();
+                }
+                return;
+            }
+            entries.emplace_back(id, delta);
+            if (entries.size() >= LOG_COLLECT_ENTRIES && !localLog.log->signalled) {
+                localLog.log->signalled = true;  // Una sola vez por log hasta que el GC lo recoja
+                signal = true;
+            }
+            drain = entries.size() >= 2 * LOG_COLLECT_ENTRIES;
+        }
+        if (drain) {
+            // Contrapresión: se aplican los logs en este hilo. Si collectMutex está tomado (un ciclo en curso,
+            // o este es el hilo del GC destruyendo basura) se vuelve a intentar con la próxima entrada.
+            std::unique_lock<std::mutex> collectLock(collectMutex, std::try_to_lock);
+            if (collectLock.owns_lock()) {
+                applyDeferredRefCounts();
+            }
+        } else if (signal) {
+            triggerCollection();
+        }
+    }
+
+    // Saca el log de un hilo que termina y guarda sus entradas pendientes
+    void retireLog(RefCountLog* log) {
+        std::lock_guard<std::mutex> lock(logsMutex);
+        orphanEntries.insert(orphanEntries.end(), log->entries.begin(), log->entries.end());
+        logs.erase(std::remove(logs.begin(), logs.end(), log), logs.end());
+        delete log;
+    }
+
+    // Recoge todos los logs, junta los cambios por ID y los aplica (incrementos ya, decrementos un ciclo después)
+    void applyDeferredRefCounts() {
+        std::vector<std::pair<int, int>> entries;
+        {
+            std::lock_guard<std::mutex> lock(logsMutex);
+            entries.swap(orphanEntries);
+            for (RefCountLog* log : logs) {
+                std::lock_guard<std::mutex> logLock(log->logMutex);
+                entries.insert(entries.end(), log->entries.begin(), log->entries.end());
+                log->entries.clear();
+                log->signalled = false;
+            }
+        }
+
+        std::unordered_map<int, int> increments;
+        std::unordered_map<int, int> decrements;
+        for (auto& entry : entries) {
+            if (entry.second > 0) {
+                increments[entry.first] += entry.second;
+            } else {
+                decrements[entry.first] -= entry.second;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(gcMutex);
+        for (auto& increment : increments) {
+            auto node = memoryList.findById(increment.first);
+            if (node) {
+                node->refCount += increment.second;
+            }
+        }
+        for (auto& decrement : heldDecrements) {
+            auto node = memoryList.findById(decrement.first);
+            if (node) {
+                int current = node->refCount.load(std::memory_order_relaxed);
+                node->refCount.store(current > decrement.second ? current - decrement.second : 0, std::memory_order_relaxed);
+            }
+        }
+        heldDecrements.swap(decrements);
+    }
+
+    // Conteo sesgado (biased reference counting): cada nodo recuerda el hilo que lo creó. Ese hilo cuenta en
+    // biasedCount sin instrucciones atómicas; los demás usan refCount con atómicos. Si un hilo ajeno dejaría
+    // el contador compartido negativo, en vez de soltar su referencia se la pasa a la cola del dueño y le pide
+    // que junte los dos contadores ("merge") la próxima vez que use un MPointer<T>; si el dueño ya terminó,
+    // el merge lo hace el mismo hilo que lo pide, y si el dueño no vuelve a usar el nodo lo hace el GC
+    // (drainMergeQueues). Antes del merge refCount lleva el desplazamiento UNMERGED, así que solo puede
+    // llegar a 0 después: el RMW que lo deja en 0 es el único que decide la liberación, y nadie lee el nodo
+    // después de su último RMW (un nodo encolado sigue vivo por la referencia que tiene la cola).
+    // El camino del dueño es una carga de merged y una carga y un store relaxed de biasedCount: la cola no
+    // se revisa en cada copia sino en New, cuando el dueño suelta su última referencia a un nodo, en cada
+    // ciclo del GC y al terminar el hilo.
+    static constexpr int UNMERGED = 1 << 30;
+    // biasedCount: referencias del dueño en los 32 bits bajos y, en los altos, cuántas veces las escribió
+    // (el GC compara dos lecturas para saber que el contador no cambió entre medio)
+    static constexpr uint64_t BIASED_WRITE = uint64_t(1) << 32;
+
+    static int biasedReferences(uint64_t biased) {
+        return static_cast<int>(static_cast<uint32_t>(biased));
+    }
 
-    // Metodo que se ejecuta en el hilo cada 1 segundo para limpiar la memoria
+    struct MergeQueue {
+        std::mutex queueMutex;
+        std::vector<RegistryNode*> nodes;   // Nodos del dueño que necesitan merge
+        std::atomic<bool> pending{false};
+    };
+
+    // Identidad del hilo para el conteo sesgado; al terminar el hilo hace sus merges pendientes
+    struct BiasState {
+        uint64_t ownerId = 0;
+        std::shared_ptr<MergeQueue> queue;
+        ~BiasState() {
+            if (ownerId != 0) {
+                localOwnerId = 0;  // Lo que se suelte desde aquí va por el camino de los hilos ajenos
+                localQueue = nullptr;
+                MPointerGC<T, Policy>::getInstance()->retireOwner(ownerId);
+            }
+        }
+    };
+
+    static inline thread_local BiasState localBias;
+    // Copias triviales de localBias para el camino rápido (sin el wrapper de thread_local con destructor)
+    static inline thread_local uint64_t localOwnerId = 0;
+    static inline thread_local MergeQueue* localQueue = nullptr;
+    static inline std::atomic<uint64_t> nextOwnerId{1};
+    std::mutex biasMutex;  // Protege owners
+    std::unordered_map<uint64_t, std::shared_ptr<MergeQueue>> owners;  // Hilos vivos que son dueños de nodos
+
+    // ID de dueño del hilo actual (se asigna la primera vez)
+    uint64_t currentOwner() {
+        if (localOwnerId != 0) {
+            return localOwnerId;
+        }
+        // pendingReclaims se construye antes que localBias para destruirse después: ~BiasState puede liberar
+        // objetos (modo inmediato) mientras terminan los thread_local del hilo
+        pendingReclaims.reserve(1);
+        if (localBias.ownerId == 0) {
+            localBias.ownerId = nextOwnerId.fetch_add(1, std::memory_order_relaxed);
+            localBias.queue = std::make_shared<MergeQueue>();
+            std::lock_guard<std::mutex> lock(biasMutex);
+            owners[localBias.ownerId] = localBias.queue;
+            localOwnerId = localBias.ownerId;
+            localQueue = localBias.queue.get();
+        }
+        return localBias.ownerId;
+    }
+
+    // Atiende un nodo sacado de una cola: suma biasedCount a refCount (si el dueño no lo hizo ya al soltar su
+    // última referencia) y suelta la referencia que dejó la cola. Solo lo puede hacer el dueño (o quien pidió
+    // el merge si el dueño ya terminó, o el GC si nadie tiene referencias). Si el total queda en 0 se avisa
+    // aquí (en modo inmediato se libera, no hay hilo del GC que lo encuentre después)
+    void mergeNode(RegistryNode* node) {
+        int id = node->id;
+        int delta = -1;  // La referencia de la cola
+        if (!node->merged.load(std::memory_order_relaxed)) {
+            delta += biasedReferences(node->biasedCount.load(std::memory_order_relaxed)) - UNMERGED;
+            node->biasedCount.store(0, std::memory_order_relaxed);
+            node->merged.store(true, std::memory_order_relaxed);
+        }
+        node->mergeRequested.store(false, std::memory_order_relaxed);
+        if (node->refCount.fetch_add(delta, std::memory_order_acq_rel) + delta == 0) {  // Último acceso al nodo
+            releasedLastReference(id);
+        }
+    }
+
+    // Referencias que ve el programa: sin el desplazamiento, con las del dueño y sin la de la cola
+    static int visibleRefCount(const RegistryNode& node) {
+        int count = node.refCount.load(std::memory_order_relaxed);
+        if (count >= UNMERGED / 2) {
+            count += biasedReferences(node.biasedCount.load(std::memory_order_relaxed)) - UNMERGED;
+        }
+        if (node.mergeRequested.load(std::memory_order_relaxed)) {
+            --count;
+        }
+        return count;
+    }
+
+    // El dueño atiende los merges que le pidieron otros hilos
+    void processMergeQueue() {
+        std::vector<RegistryNode*> nodes;
+        {
+            std::lock_guard<std::mutex> lock(localQueue->queueMutex);
+            nodes.swap(localQueue->nodes);
+            localQueue->pending.store(false, std::memory_order_relaxed);
+        }
+        for (RegistryNode* node : nodes) {
+            mergeNode(node);
+        }
+    }
+
+    // Un hilo ajeno (que ganó el exchange de mergeRequested) deja su referencia en la cola del dueño
+    void requestMerge(RegistryNode* node) {
+        {
+            std::lock_guard<std::mutex> lock(biasMutex);
+            auto it = owners.find(node->owner);
+            if (it != owners.end()) {
+                std::lock_guard<std::mutex> queueLock(it->second->queueMutex);
+                it->second->nodes.push_back(node);
+                it->second->pending.store(true, std::memory_order_release);
+                return;
+            }
+        }
+        // El dueño ya terminó (retireOwner pasó por biasMutex, sus últimos biasedCount son visibles) y solo
+        // este hilo ganó el exchange de mergeRequested: el merge se hace aquí, fuera de los locks
+        mergeNode(node);
+    }
+
+    // El hilo dueño terminó: hace él mismo los merges que le quedaban pendientes
+    void retireOwner(uint64_t ownerId) {
+        std::vector<RegistryNode*> nodes;
+        {
+            std::lock_guard<std::mutex> lock(biasMutex);
+            auto it = owners.find(ownerId);
+            if (it == owners.end()) {
+                return;
+            }
+            std::lock_guard<std::mutex> queueLock(it->second->queueMutex);
+            nodes.swap(it->second->nodes);
+            owners.erase(it);
+        }
+        for (RegistryNode* node : nodes) {
+            mergeNode(node);
+        }
+    }
+
+    // El GC hace los merges que un dueño vivo no atiende porque ya no usa esos nodos. Solo se puede si fuera de
+    // la referencia de la cola no queda ninguna: entonces ningún hilo vuelve a tocar los contadores. refCount
+    // se lee entre dos lecturas de biasedCount; si el dueño lo escribió entre medio, el nodo queda en la cola
+    // para el próximo ciclo (o para el propio dueño). Si el dueño ya hizo el merge solo falta soltar la de la
+    // cola (el dueño publica merged antes de dejar biasedCount en 0).
+    void drainMergeQueues() {
+        std::vector<RegistryNode*> idle;
+        {
+            std::lock_guard<std::mutex> lock(biasMutex);
+            for (auto& entry : owners) {
+                MergeQueue& queue = *entry.second;
+                std::lock_guard<std::mutex> queueLock(queue.queueMutex);
+                auto unused = std::partition(queue.nodes.begin(), queue.nodes.end(), [](RegistryNode* node) {
+                    uint64_t biased = node->biasedCount.load(std::memory_order_acquire);
+                    bool merged = node->merged.load(std::memory_order_relaxed);
+                    int shared = node->refCount.load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    bool stable = node->biasedCount.load(std::memory_order_relaxed) == biased;
+                    return !(merged || (stable && biasedReferences(biased) + shared - UNMERGED == 1));
+                });
+                idle.insert(idle.end(), unused, queue.nodes.end());
+                queue.nodes.erase(unused, queue.nodes.end());
+            }
+        }
+        for (RegistryNode* node : idle) {
+            mergeNode(node);  // Fuera de los locks: en modo inmediato libera el objeto
+        }
+    }
+
+    // Un nodo es basura cuando no le quedan referencias (en modo sesgado refCount no llega a 0 sin el merge)
+    static bool isGarbage(const RegistryNode& node) {
+        return node.refCount.load(std::memory_order_acquire) == 0;
+    }
+
+    // Destrucción en paralelo de la basura barrida (nullptr = el hilo del GC destruye solo)
+    std::unique_ptr<MPointerWorkerPool> sweepPool;
+    static constexpr size_t PARALLEL_DISPOSE_MIN = 4096;  // Objetos mínimos por worker para repartir un lote
+    std::atomic<size_t> lastCollectionMicros{0};  // Duración del último ciclo completo
+    std::atomic<size_t> lastCollectionFreed{0};   // Objetos liberados en el último ciclo
+    std::atomic<size_t> collectionCount{0};       // Ciclos de recolección completados
+    size_t cycleFreed = 0;  // Objetos liberados en el ciclo en curso (protegido por gcMutex)
+
+    // Estadísticas acumuladas (relaxed: se leen sin lock y pueden ir un poco desfasadas entre sí)
+    std::atomic<size_t> allocations{0};  // Objetos registrados desde el inicio
+    std::atomic<size_t> frees{0};        // Objetos liberados desde el inicio
+    std::atomic<size_t> totalPauseMicros{0};
+
+    // Recolección incremental: cada rebanada del barrido revisa como máximo este número de objetos
+    // o dura como máximo este tiempo (0 = sin límite); entre rebanadas se suelta gcMutex
+    size_t sliceObjectBudget = 0;
+    std::chrono::microseconds sliceTimeBudget{0};
+
+    // Histograma de pausas: el bucket k cuenta las rebanadas que duraron menos de 2^k microsegundos
+    static constexpr size_t PAUSE_BUCKETS = 32;
+    std::atomic<size_t> pauseHistogram[PAUSE_BUCKETS] = {};
+    std::atomic<size_t> maxPauseMicros{0};
+
+    // Recorridos del heap (forEachLive): mientras haya alguno activo los objetos que se liberan no se destruyen
+    // ni se reciclan, quedan en deferredGarbage hasta que termine el último (como un período de gracia de RCU).
+    // La compactación mueve objetos, así que espera a los recorridos con relocationMutex
+    std::shared_mutex relocationMutex;  // Compartido: recorridos; exclusivo: compact()
+    std::mutex walkMutex;               // Protege activeWalkers (al cambiar) y deferredGarbage
+    std::atomic<size_t> activeWalkers{0};
+    std::vector<T*> deferredGarbage;
+
+    // Si hay un recorrido activo guarda las direcciones para después y devuelve true
+    bool deferIfWalking(T* const* addresses, size_t count) {
+        if (activeWalkers.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(walkMutex);
+        if (activeWalkers.load(std::memory_order_relaxed) == 0) {
+            return false;  // El último recorrido terminó mientras tanto
+        }
+        deferredGarbage.insert(deferredGarbage.end(), addresses, addresses + count);
+        return true;
+    }
+
+    // Termina un recorrido; el último destruye lo que se liberó mientras tanto
+    void finishWalk() {
+        std::vector<T*> garbage;
+        {
+            std::lock_guard<std::mutex> lock(walkMutex);
+            if (activeWalkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                garbage.swap(deferredGarbage);
+            }
+        }
+        if (!garbage.empty()) {
+            DisposeObjects(garbage);
+        }
+    }
+
+    // Vida de los objetos liberados (bucket k: menos de 2^k microsegundos / ciclos sobrevividos)
+    static constexpr size_t LIFETIME_BUCKETS = 40;
+    std::atomic<size_t> lifetimeHistogram[LIFETIME_BUCKETS] = {};
+    std::atomic<size_t> survivedHistogram[LIFETIME_BUCKETS] = {};
+    // La duración se mide con el reloj del tracer (TSC) y solo si se pidió: son dos lecturas del reloj
+    // por objeto. Los ciclos sobrevividos se cuentan siempre
+    std::atomic<bool> lifetimeTiming{false};
+    uint64_t sweepNow = 0;  // Hora de la rebanada actual del barrido (requiere gcMutex)
+
+    // Bucket k para valores menores que 2^k (0 va al bucket 0)
+    static size_t histogramBucket(size_t value, size_t buckets) {
+        size_t bucket = 0;
+        while ((size_t(1) << bucket) <= value && bucket + 1 < buckets) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // Anota la vida de un nodo que sale del registro (birthTime 0: nació sin medición de tiempo)
+    void recordLifetime(const RegistryNode& node, uint64_t now) {
+        if (node.birthTime != 0) {
+            double ticks = now > node.birthTime ? static_cast<double>(now - node.birthTime) : 0;
+            size_t micros = static_cast<size_t>(ticks / MPointerTrace::ticksPerMicro());
+            lifetimeHistogram[histogramBucket(micros, LIFETIME_BUCKETS)].fetch_add(1, std::memory_order_relaxed);
+        }
+        size_t cycles = collectionCount.load(std::memory_order_relaxed) - node.birthCycle;
+        survivedHistogram[histogramBucket(cycles, LIFETIME_BUCKETS)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Disparadores de la recolección: el hilo del GC duerme en triggerCv hasta que se cruza un umbral
+    // o vence el intervalo actual (maxLatency, o el que calcula el modo adaptativo)
+    std::mutex triggerMutex;  // Protege triggers, running, triggered y collectionInterval
+    std::condition_variable triggerCv;
+    CollectionTriggers triggers;
+    bool triggered = false;  // Se cruzó un umbral desde el último ciclo
+    std::chrono::milliseconds collectionInterval{1000};
+    std::atomic<size_t> bytesSinceCollection{0};
+    std::atomic<size_t> pendingZeroCount{0};  // Aproximado: el conteo diferido no lo alimenta
+    std::atomic<size_t> bytesThreshold{0};    // Copias de los umbrales para el camino rápido sin lock
+    std::atomic<size_t> pendingThreshold{0};
+    std::chrono::steady_clock::time_point lastCycleEnd = std::chrono::steady_clock::now();
+
+    // Modo inmediato: destruye el objeto y retira su nodo en el mismo hilo que soltó la última referencia.
+    // Si el destructor suelta otros MPointer<T> (p. ej. el siguiente nodo de una lista) esos no se liberan
+    // de forma recursiva: se encolan y los libera la llamada más externa, así la pila no crece con la lista.
+    void reclaimNow(int id) {
+        pendingReclaims.push_back(id);
+        if (reclaiming) {
+            return;
+        }
+        reclaiming = true;
+        while (!pendingReclaims.empty()) {
+            int next = pendingReclaims.back();
+            pendingReclaims.pop_back();
+            FreeMemory(next);
+        }
+        reclaiming = false;
+    }
+
+    // Despierta al GC (solo quien cruza el umbral avisa, los demás no pagan el notify).
+    // En modo manual no hay hilo: el que cruza el umbral recolecta, salvo que ya esté dentro de una recolección.
+    void triggerCollection() {
+        if (manual.load(std::memory_order_relaxed)) {
+            if (!MPointerRuntime::isCollecting()) {
+                bytesSinceCollection.store(0, std::memory_order_relaxed);
+                pendingZeroCount.store(0, std::memory_order_relaxed);
+                collectCycle();
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(triggerMutex);
+            triggered = true;
+        }
+        triggerCv.notify_one();
+    }
+
+    void noteAllocation(size_t bytes) {
+        size_t threshold = bytesThreshold.load(std::memory_order_relaxed);
+        size_t before = bytesSinceCollection.fetch_add(bytes, std::memory_order_relaxed);
+        if (threshold != 0 && before < threshold && before + bytes >= threshold) {
+            triggerCollection();
+        }
+    }
+
+    void noteZeroCount() {
+        size_t threshold = pendingThreshold.load(std::memory_order_relaxed);
+        size_t before = pendingZeroCount.fetch_add(1, std::memory_order_relaxed);
+        if (threshold != 0 && before + 1 == threshold) {
+            triggerCollection();
+        }
+    }
+
+    // Modo adaptativo: el siguiente intervalo es el tiempo estimado para llegar al umbral de bytes con la
+    // tasa de reserva medida, sin bajar de 20 veces la última pausa (el GC no ocupa más de ~5% del tiempo)
+    // y acotado entre minInterval y maxLatency (requiere triggerMutex)
+    void adaptIntervalLocked(size_t bytes, std::chrono::steady_clock::duration elapsed,
+                             std::chrono::steady_clock::duration pause) {
+        auto maxLatency = triggers.maxLatency.count() != 0 ? triggers.maxLatency : std::chrono::milliseconds(1000);
+        if (!triggers.adaptive) {
+            collectionInterval = maxLatency;
+            return;
+        }
+        auto next = maxLatency;
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        if (triggers.bytesAllocated != 0 && bytes != 0 && seconds > 0) {
+            double rate = bytes / seconds;  // Bytes por segundo
+            next = std::chrono::milliseconds(static_cast<long long>(triggers.bytesAllocated / rate * 1000));
+        }
+        auto floor = std::max(triggers.minInterval, std::chrono::duration_cast<std::chrono::milliseconds>(pause * 20));
+        collectionInterval = std::clamp(next, std::min(floor, maxLatency), maxLatency);
+    }
+
+    // Bucle del hilo del GC: despierta por umbral o por intervalo y ejecuta un ciclo
     void GC_CleanupThread() {
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));  // Espera de 1 segundo
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(triggerMutex);
+                auto wakeUp = [this]() { return !running || triggered; };
+                if (triggers.maxLatency.count() == 0 && !triggers.adaptive) {
+                    triggerCv.wait(lock, wakeUp);  // Solo umbrales, sin temporizador
+                } else {
+                    triggerCv.wait_for(lock, collectionInterval, wakeUp);
+                }
+                if (!running) {
+                    return;
+                }
+                triggered = false;
+            }
+            size_t bytes = bytesSinceCollection.exchange(0, std::memory_order_relaxed);
+            pendingZeroCount.store(0, std::memory_order_relaxed);
+            auto cycleStart = std::chrono::steady_clock::now();
+            collectCycle();
+            auto cycleEnd = std::chrono::steady_clock::now();
+
+            std::lock_guard<std::mutex> lock(triggerMutex);
+            adaptIntervalLocked(bytes, cycleEnd - lastCycleEnd, cycleEnd - cycleStart);
+            lastCycleEnd = cycleEnd;
+        }
+    }
+
+    // Un ciclo de recolección: recorta el pool, devuelve chunks inactivos y barre la lista
+    // Con `full` siempre se barre toda la lista y el conteo diferido se aplica dos veces, para que los
+    // decrementos anotados antes de la llamada (que el GC retiene un ciclo) también se apliquen.
+    CollectionStats collectCycle(bool full = false) {
+        // El pool se recorta a lo que realmente se reutilizó en el ciclo anterior
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            trimLocked(reusedSinceTrim);
+            reusedSinceTrim = 0;
+        }
+        MPointerHeap::getInstance().releaseIdleChunks();  // Devuelve al SO los chunks inactivos
+
+        MPointerRuntime::CollectingScope collecting;
+        std::lock_guard<std::mutex> collectLock(collectMutex);
+        auto cycleStart = std::chrono::steady_clock::now();
+        MPointerTrace::trace(MPointerTraceKind::SweepStart, 0, collectionCount.load(std::memory_order_relaxed));
+        MPOINTER_PROBE1(collect_begin, collectionCount.load(std::memory_order_relaxed));
+        applyDeferredRefCounts();  // Sin efecto si el conteo diferido nunca se activó
+        if (full) {
+            applyDeferredRefCounts();
+        }
+        drainMergeQueues();  // Sin efecto si el conteo sesgado nunca se activó
+        bool major;
+        {
             std::lock_guard<std::mutex> lock(gcMutex);
-            std::cout << "[GC Thread] Revisando referencias..." << std::endl;
-
-            // Recorre los nodos de la lista enlazada y libera aquellos con refCount 0
-            for (int id = 1; id <= memoryList.getCurrentId(); ++id) {
-                int refCount = memoryList.getRefCountById(id);
-                if (refCount == 0) {
-                    //std::cout << "[GC Thread] refCount 0 for ID: " << id << std::endl;
-                    FreeMemory(id);  // Libera la memoria
+            major = full || !generational || (minorCollections + majorCollections + 1) % majorInterval == 0;
+            if (generational) {
+                ++(major ? majorCollections : minorCollections);
+            }
+        }
+        if (major) {
+            sweepRegistry();  // Pase completo (o mayor): toda la lista
+        }
+        if (generational) {
+            sweepNursery();   // Pase menor: solo los objetos jóvenes (en el mayor envejece a los sobrevivientes)
+        }
+        CollectionStats stats;
+        stats.major = major;
+        stats.duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - cycleStart);
+        lastCollectionMicros.store(static_cast<size_t>(stats.duration.count()), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(gcMutex);
+        stats.freed = cycleFreed;
+        stats.bytesFreed = cycleFreed * sizeof(T);
+        stats.remaining = memoryList.size();
+        lastCollectionFreed.store(cycleFreed, std::memory_order_relaxed);
+        collectionCount.fetch_add(1, std::memory_order_release);
+        MPointerTrace::trace(MPointerTraceKind::SweepEnd, 0, cycleFreed);
+        MPOINTER_PROBE2(collect_end, cycleFreed, static_cast<long long>(stats.duration.count()));
+        cycleFreed = 0;
+        return stats;
+    }
+
+    static constexpr int SNAPSHOT_SLICE = 4096;  // Registros revisados por cada toma de gcMutex en forEachLive() y snapshot()
+
+    template <typename U, typename UPolicy>
+    static void addSnapshotEdge(MPointerHeapSnapshot& out, uint16_t fromType, int fromId,
+                                const MPointer<U, UPolicy>& target) {
+        int toId = target.getId();
+        if (toId > 0) {
+            out.edges.push_back({fromId, toId, fromType, out.typeIndex<U>(), 0});
+        }
+    }
+
+    // Saca de la lista un nodo con refCount 0 y guarda su dirección para destruirla (requiere gcMutex)
+    void detachLocked(RegistryNode* node, std::vector<T*>& garbage) {
+        int id = node->id;
+        if (node->address) {
+            garbage.push_back(node->address);
+        }
+        recordLifetime(*node, sweepNow);
+        memoryList.remove(node);
+        ++cycleFreed;
+        frees.fetch_add(1, std::memory_order_relaxed);
+        MPointerTrace::trace(MPointerTraceKind::Free, id);
+        MPOINTER_PROBE1(free, id);
+    }
+
+    // Procesa el registro en rebanadas acotadas por el presupuesto de pausa.
+    // `step` revisa un elemento y devuelve false cuando ya no quedan; corre con gcMutex tomado.
+    // Entre rebanadas se suelta el lock y se destruye la basura encontrada, así los mutadores pueden avanzar.
+    template <typename Step>
+    void sweepInSlices(Step step) {
+        bool done = false;
+        while (!done) {
+            std::vector<T*> garbage;
+            auto start = std::chrono::steady_clock::now();
+            size_t visited = 0;
+            {
+                std::lock_guard<std::mutex> lock(gcMutex);
+                MPointerTrace::trace(MPointerTraceKind::SliceStart);
+                sweepNow = MPointerTrace::now();  // Una sola lectura del reloj por rebanada para la vida de los liberados
+                while (true) {
+                    if (!step(garbage)) {
+                        done = true;
+                        break;
+                    }
+                    ++visited;
+                    if (sliceObjectBudget != 0 && visited >= sliceObjectBudget) {
+                        break;
+                    }
+                    // El reloj se consulta cada 16 objetos para que medir no cueste más que barrer
+                    if (sliceTimeBudget.count() != 0 && visited % 16 == 0 &&
+                        std::chrono::steady_clock::now() - start >= sliceTimeBudget) {
+                        break;
+                    }
                 }
             }
+            MPointerTrace::trace(MPointerTraceKind::SliceEnd, 0, visited);
+            recordPause(std::chrono::steady_clock::now() - start);
+
+            // Los destructores corren sin gcMutex: pueden soltar otros MPointers del mismo tipo
+            disposeGarbage(garbage);
+            if (!done) {
+                std::this_thread::yield();
+            }
         }
     }
 
+    // Barrido de los nodos vivos de la lista; el cursor de la lista continúa donde quedó la rebanada anterior
+    // (el costo depende de los objetos vivos, no de todos los IDs que se repartieron alguna vez)
+    void sweepRegistry() {
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            memoryList.startCursor();
+        }
+        sweepInSlices([this](std::vector<T*>& garbage) {
+            RegistryNode* node = memoryList.nextCursor();
+            if (node == nullptr) {
+                return false;
+            }
+            if (isGarbage(*node)) {
+                detachLocked(node, garbage);
+            }
+            return true;
+        });
+    }
+
+    // Destruye la basura de una rebanada. Con workers, el lote se reparte en tramos de al menos
+    // PARALLEL_DISPOSE_MIN objetos (como mucho uno por worker); los lotes chicos se destruyen en este hilo,
+    // porque despertar al pool cuesta más que los destructores.
+    void disposeGarbage(const std::vector<T*>& garbage) {
+        size_t chunks = sweepPool ? std::min(sweepPool->size(), garbage.size() / PARALLEL_DISPOSE_MIN) : 0;
+        if (chunks < 2) {
+            for (T* address : garbage) {
+                DisposeObject(address);
+            }
+            return;
+        }
+        size_t chunkSize = (garbage.size() + chunks - 1) / chunks;
+        sweepPool->parallelFor(chunks, [this, &garbage, chunkSize](size_t chunk) {
+            auto first = garbage.begin() + chunk * chunkSize;
+            auto last = garbage.begin() + std::min(garbage.size(), (chunk + 1) * chunkSize);
+            DisposeObjects(std::vector<T*>(first, last));
+        });
+    }
+
+    // Revisa solo la nursery: libera los jóvenes con refCount 0 y promueve a los que sobreviven
+    void sweepNursery() {
+        std::vector<int> young;
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            young.swap(nursery);  // Los objetos creados durante el barrido van a la nursery nueva
+        }
+        size_t index = 0;
+        sweepInSlices([this, &young, &index](std::vector<T*>& garbage) {
+            if (index == young.size()) {
+                return false;
+            }
+            int id = young[index++];
+            auto node = memoryList.findById(id);
+            if (node == nullptr) {
+                return true;  // Ya se liberó (FreeMemory o pase mayor)
+            }
+            if (isGarbage(*node)) {
+                detachLocked(node, garbage);
+            } else if (++node->age >= promotionAge) {
+                ++promotedObjects;  // Pasa a la generación vieja
+            } else {
+                nursery.push_back(id);
+            }
+            return true;
+        });
+    }
+
+    // Anota la duración de una pausa (tiempo con gcMutex tomado) en el histograma
+    void recordPause(std::chrono::steady_clock::duration pause) {
+        auto micros = static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(pause).count());
+        pauseHistogram[histogramBucket(micros, PAUSE_BUCKETS)].fetch_add(1, std::memory_order_relaxed);
+        totalPauseMicros.fetch_add(micros, std::memory_order_relaxed);
+        size_t previous = maxPauseMicros.load(std::memory_order_relaxed);
+        while (micros > previous && !maxPauseMicros.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Saca de la lista los nodos con refCount 0 y devuelve sus direcciones (requiere gcMutex)
+    void collectGarbageLocked(std::vector<T*>& garbage) {
+        memoryList.removeIf([this, &garbage](auto& node) {
+            if (!isGarbage(node)) {
+                return false;
+            }
+            frees.fetch_add(1, std::memory_order_relaxed);
+            MPointerTrace::trace(MPointerTraceKind::Free, node.id);
+            MPOINTER_PROBE1(free, node.id);
+            if (node.address) {
+                garbage.push_back(node.address);
+            }
+            return true;
+        });
+    }
+
+    // Devuelve memoria sin objeto al slab o al allocator (requiere poolMutex)
+    void releaseStorageLocked(void* memory) {
+        if constexpr (USE_SLAB) {
+            slab->deallocate(memory);
+        } else {
+            ::operator delete(memory);
+        }
+        MPointerRuntime::getInstance().credit(sizeof(T));
+    }
+
+    // Libera objetos del pool hasta dejar como máximo `keep` (requiere poolMutex)
+    void trimLocked(size_t keep) {
+        while (recyclePool.size() > keep) {
+            releaseStorageLocked(recyclePool.back());
+            recyclePool.pop_back();
+        }
+    }
 
     // Constructor que inicia el hilo de limpieza
     MPointerGC() {
+        // Recolección de emergencia cuando una reserva de cualquier tipo superaría el límite del heap
+        MPointerRuntime::getInstance().registerCollector(this, [this]() {
+            collectCycle(true);
+            trimRecyclePool(0);
+        }, [this](MPointerHeapSnapshot& out) {
+            snapshot(out);
+        });
         gcThread = std::thread(&MPointerGC::GC_CleanupThread, this);
     }
 
 public:
     //Metodo estatica que vuelve a la clase Singleton
-    static MPointerGC<T>* getInstance() {
+    static MPointerGC<T, Policy>* getInstance() {
         std::lock_guard<std::mutex> lock(gcMutex);
         if (instance == nullptr) {
-            instance = new MPointerGC<T>();
+            instance = new MPointerGC<T, Policy>();
         }
         return instance;
     }
 
     // Metodo de depuracion
+    // (imprime desde forEachLive, sin gcMutex tomado; requiere operator<< para T)
     void debug() {
-        std::lock_guard<std::mutex> lock(gcMutex);
         std::cout << "[GC Debug] Estado actual de la memoria:" << std::endl;
+        forEachLive([](const MPointerLiveObject<T>& object) {
+            std::cout << "ID: " << object.id
+                      << ", Dirección de Memoria: " << object.address
+                      << ", Valor: " << *object.address
+                      << ", RefCount: " << object.refCount
+                      << std::endl;
+        });
+    }
 
-        for (int id = 1; id <= memoryList.getCurrentId(); ++id) {
-            T* address = memoryList.getAddressById(id);
-            int refCount = memoryList.getRefCountById(id);
-            if (address != nullptr) {
-                std::cout << "ID: " << id
-                          << ", Dirección de Memoria: " << address
-                          << ", Valor: " << *address
-                          << ", RefCount: " << refCount
-                          << std::endl;
+    // Recorre los objetos vivos sin detener al recolector ni a los mutadores.
+    // Primero copia el registro (id, dirección, refCount) tomando gcMutex por rebanadas de SNAPSHOT_SLICE
+    // IDs; después llama a `visit` con cada registro sin ningún lock. Los objetos creados después de empezar
+    // no aparecen, y los que se liberan durante el recorrido no se destruyen hasta que termina, así que
+    // las direcciones siguen siendo válidas (el contenido lo pueden estar cambiando otros hilos).
+    // Devuelve la cantidad de objetos visitados. `visit` no debe llamar a compact() de este tipo.
+    template <typename Visit>
+    size_t forEachLive(Visit visit) {
+        std::shared_lock<std::shared_mutex> relocationLock(relocationMutex);
+        {
+            std::lock_guard<std::mutex> lock(walkMutex);
+            activeWalkers.fetch_add(1, std::memory_order_acq_rel);
+        }
+        std::vector<MPointerLiveObject<T>> live;
+        try {
+            int last;
+            {
+                std::lock_guard<std::mutex> lock(gcMutex);
+                last = memoryList.getCurrentId();
+                live.reserve(memoryList.size());
+            }
+            for (int first = 1; first <= last; first += SNAPSHOT_SLICE) {
+                std::lock_guard<std::mutex> lock(gcMutex);
+                int end = std::min(last, first + SNAPSHOT_SLICE - 1);
+                for (int id = first; id <= end; ++id) {
+                    const RegistryNode* node = memoryList.findById(id);
+                    if (node == nullptr || node->address == nullptr) {
+                        continue;
+                    }
+                    int refCount = visibleRefCount(*node);
+                    live.push_back({id, node->address, refCount, sizeof(T)});
+                }
+            }
+            for (const MPointerLiveObject<T>& object : live) {
+                visit(object);
+            }
+        } catch (...) {
+            finishWalk();
+            throw;
+        }
+        finishWalk();
+        return live.size();
+    }
+
+    // Agrega los objetos vivos de este tipo (y sus aristas, si MPointerSnapshotEdges<T> las conoce) al snapshot.
+    // gcMutex se toma por rebanadas de SNAPSHOT_SLICE nodos y solo para copiar registros de 24 bytes; los
+    // mutadores siguen corriendo, así que las aristas son una foto aproximada de un heap que cambia.
+    void snapshot(MPointerHeapSnapshot& out) {
+        std::lock_guard<std::mutex> collectLock(collectMutex);  // Sin barridos ni compactación a la vez (comparten el cursor)
+        uint16_t type = out.typeIndex<T>();
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            out.objects.reserve(out.objects.size() + memoryList.size());
+            memoryList.startCursor();
+        }
+        bool done = false;
+        while (!done) {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            for (int visited = 0; visited < SNAPSHOT_SLICE; ++visited) {
+                const RegistryNode* node = memoryList.nextCursor();
+                if (node == nullptr) {
+                    done = true;
+                    break;
+                }
+                if (node->address == nullptr) {
+                    continue;
+                }
+                int id = node->id;
+                int refCount = visibleRefCount(*node);
+                out.objects.push_back({reinterpret_cast<uint64_t>(node->address), static_cast<uint32_t>(sizeof(T)),
+                                       id, refCount, type, static_cast<uint16_t>(std::min(node->age, 0xFFFF))});
+                MPointerSnapshotEdges<T>::forEach(*node->address, [&](const auto& target) {
+                    addSnapshotEdge(out, type, id, target);
+                });
             }
         }
     }
 
     //Obtener el refCount de un nodo especifico (es decir de un MPointer)
+    // (en modo sesgado suma también las referencias del hilo dueño que aún no se juntaron)
     int getRefCount(int id) const {
-        return memoryList.getRefCountById(id);
+        std::lock_guard<std::mutex> lock(gcMutex);
+        const RegistryNode* node = memoryList.findById(id);
+        if (node == nullptr) {
+            return 0;
+        }
+        return visibleRefCount(*node);
     }
 
     //Obtener la dirrecion de memoria guardada dentro de la lista enlazada
     T* getAddress(int id) const {
+        std::lock_guard<std::mutex> lock(gcMutex);
         return memoryList.getAddressById(id);
     }
 
+    // Activa el modo generacional (los objetos creados antes se consideran viejos)
+    void setGenerational(bool enabled) {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        generational = enabled;
+        if (!enabled) {
+            nursery.clear();
+        }
+    }
+
+    // Ciclos que un objeto debe sobrevivir en la nursery para ser promovido
+    void setPromotionAge(int age) {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        promotionAge = age;
+    }
+
+    // Cada cuántos ciclos se hace un pase mayor sobre la generación vieja
+    void setMajorCollectionInterval(int interval) {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        majorInterval = interval > 0 ? interval : 1;
+    }
+
+    size_t getNurserySize() const {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        return nursery.size();
+    }
+
+    size_t getMinorCollections() const {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        return minorCollections;
+    }
+
+    size_t getMajorCollections() const {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        return majorCollections;
+    }
+
+    size_t getPromotedObjects() const {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        return promotedObjects;
+    }
+
+    // Conteo de referencias diferido: las copias/destrucciones de MPointers van a un log por hilo
+    // y el GC las aplica en cada ciclo (el refCount que se consulta puede ir un ciclo atrasado)
+    void setDeferredRefCounting(bool enabled) {
+        refCountMode.store(enabled ? RefCountMode::Deferred : RefCountMode::Locked, std::memory_order_relaxed);
+    }
+
+    // Modo de conteo de referencias. Los modos atómico y sesgado guardan el nodo del registro en cada
+    // MPointer, así que conviene elegirlos antes de crear objetos de este tipo.
+    void setRefCountMode(RefCountMode mode) {
+        refCountMode.store(mode, std::memory_order_relaxed);
+    }
+
+    RefCountMode getRefCountMode() const {
+        return refCountMode.load(std::memory_order_relaxed);
+    }
+
+    // Hilos que destruyen en paralelo la basura de cada rebanada (1 = solo el hilo del GC).
+    // El recorrido y la desconexión de nodos siguen siendo seriales bajo gcMutex y respetan el presupuesto
+    // incremental; con rebanadas chicas (menos de PARALLEL_DISPOSE_MIN objetos por worker) no se reparte nada.
+    // También se limita a los núcleos disponibles: más hilos que núcleos solo agregan cambios de contexto.
+    void setSweepWorkers(size_t workers) {
+        size_t cores = std::thread::hardware_concurrency();
+        if (cores != 0) {
+            workers = std::min(workers, static_cast<size_t>(cores));
+        }
+        std::lock_guard<std::mutex> lock(collectMutex);
+        sweepPool.reset(workers > 1 ? new MPointerWorkerPool(workers) : nullptr);
+    }
+
+    // Duración del último ciclo de recolección en microsegundos
+    size_t getLastCollectionMicros() const {
+        return lastCollectionMicros.load(std::memory_order_relaxed);
+    }
+
+    // Ciclos de recolección completados
+    size_t getCollectionCount() const {
+        return collectionCount.load(std::memory_order_acquire);
+    }
+
+    // Objetos liberados en el último ciclo de recolección
+    size_t getLastCollectionFreed() const {
+        return lastCollectionFreed.load(std::memory_order_relaxed);
+    }
+
+    // Estadísticas sin tomar ningún lock (contadores relaxed)
+    MPointerGCStats stats() const {
+        MPointerGCStats result;
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        result.frees = frees.load(std::memory_order_relaxed);
+        result.liveObjects = result.allocations > result.frees ? result.allocations - result.frees : 0;
+        result.liveBytes = result.liveObjects * sizeof(T);
+        result.allocatorCalls = allocatorCalls.load(std::memory_order_relaxed);
+        result.recycleHits = recycleHits.load(std::memory_order_relaxed);
+        result.collections = collectionCount.load(std::memory_order_relaxed);
+        result.lastCollectionMicros = lastCollectionMicros.load(std::memory_order_relaxed);
+        result.lastCollectionFreed = lastCollectionFreed.load(std::memory_order_relaxed);
+        result.totalPauseMicros = totalPauseMicros.load(std::memory_order_relaxed);
+        result.maxPauseMicros = maxPauseMicros.load(std::memory_order_relaxed);
+        result.pauseHistogram = getPauseHistogram();
+        result.lifetimeHistogram = getLifetimeHistogram();
+        result.survivedHistogram = getSurvivedHistogram();
+        return result;
+    }
+
+    // Recolección completa y bloqueante en el hilo que llama (no espera al hilo del GC).
+    // Con `full` en false corre el mismo ciclo que haría el hilo del GC (p. ej. solo la nursery).
+    CollectionStats collect(bool full = true) {
+        bytesSinceCollection.store(0, std::memory_order_relaxed);
+        pendingZeroCount.store(0, std::memory_order_relaxed);
+        return collectCycle(full);
+    }
+
+    // Manual / Immediate: detienen el hilo del GC (cero despertares); Background lo vuelve a arrancar
+    void setCollectionMode(CollectionMode mode) {
+        std::lock_guard<std::mutex> threadLock(threadMutex);
+        if (mode == collectionMode) {
+            return;
+        }
+        CollectionMode previous = collectionMode;
+        collectionMode = mode;
+        manual.store(mode == CollectionMode::Manual, std::memory_order_relaxed);
+        immediate.store(mode == CollectionMode::Immediate, std::memory_order_relaxed);
+        if (mode != CollectionMode::Background) {
+            if (previous == CollectionMode::Background) {
+                {
+                    std::lock_guard<std::mutex> lock(triggerMutex);
+                    running = false;
+                }
+                triggerCv.notify_one();
+                gcThread.join();
+            }
+            if (mode == CollectionMode::Immediate) {
+                collect();  // La basura anterior al cambio ya no tendría quién la libere
+            }
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(triggerMutex);
+                running = true;
+            }
+            gcThread = std::thread(&MPointerGC::GC_CleanupThread, this);
+        }
+    }
+
+    CollectionMode getCollectionMode() {
+        std::lock_guard<std::mutex> threadLock(threadMutex);
+        return collectionMode;
+    }
+
+    // Umbrales que despiertan al GC; por defecto solo maxLatency = 1 s (el temporizador original)
+    void setCollectionTriggers(const CollectionTriggers& newTriggers) {
+        {
+            std::lock_guard<std::mutex> lock(triggerMutex);
+            triggers = newTriggers;
+            collectionInterval = triggers.maxLatency.count() != 0 ? triggers.maxLatency : std::chrono::milliseconds(1000);
+            bytesThreshold.store(triggers.bytesAllocated, std::memory_order_relaxed);
+            pendingThreshold.store(triggers.pendingZeroCount, std::memory_order_relaxed);
+            triggered = true;  // El hilo recalcula su espera con los umbrales nuevos
+        }
+        triggerCv.notify_one();
+    }
+
+    CollectionTriggers getCollectionTriggers() {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        return triggers;
+    }
+
+    // Intervalo actual entre ciclos (lo ajusta el modo adaptativo)
+    std::chrono::milliseconds getCollectionInterval() {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        return collectionInterval;
+    }
+
+    size_t getBytesSinceCollection() const {
+        return bytesSinceCollection.load(std::memory_order_relaxed);
+    }
+
+    size_t getPendingZeroCount() const {
+        return pendingZeroCount.load(std::memory_order_relaxed);
+    }
+
+    // Presupuesto de cada rebanada del barrido incremental (0 = sin límite en esa dimensión)
+    void setIncrementalBudget(std::chrono::microseconds timeBudget, size_t objectBudget) {
+        std::lock_guard<std::mutex> lock(collectMutex);
+        sliceTimeBudget = timeBudget;
+        sliceObjectBudget = objectBudget;
+    }
+
+    // Histograma de pausas del barrido (bucket k: pausas de menos de 2^k microsegundos)
+    std::vector<size_t> getPauseHistogram() const {
+        std::vector<size_t> histogram;
+        for (const auto& bucket : pauseHistogram) {
+            histogram.push_back(bucket.load(std::memory_order_relaxed));
+        }
+        return histogram;
+    }
+
+    // Mide también la duración de la vida de los objetos creados desde ahora (cuesta leer el reloj en cada
+    // New y en cada liberación inmediata)
+    void setLifetimeTiming(bool enabled) {
+        if (enabled) {
+            MPointerTrace::ticksPerMicro();  // Calibra el TSC (~1 ms) aquí y no dentro de un barrido
+        }
+        lifetimeTiming.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool getLifetimeTiming() const {
+        return lifetimeTiming.load(std::memory_order_relaxed);
+    }
+
+    // Vida de los objetos liberados (solo los que nacieron con setLifetimeTiming(true)):
+    // bucket k cuenta los que vivieron menos de 2^k microsegundos
+    std::vector<size_t> getLifetimeHistogram() const {
+        std::vector<size_t> histogram;
+        for (const auto& bucket : lifetimeHistogram) {
+            histogram.push_back(bucket.load(std::memory_order_relaxed));
+        }
+        return histogram;
+    }
+
+    // Ciclos de recolección que sobrevivieron los objetos liberados (bucket k: menos de 2^k ciclos).
+    // Sirve para elegir promotionAge y el tamaño de la nursery
+    std::vector<size_t> getSurvivedHistogram() const {
+        std::vector<size_t> histogram;
+        for (const auto& bucket : survivedHistogram) {
+            histogram.push_back(bucket.load(std::memory_order_relaxed));
+        }
+        return histogram;
+    }
+
+    size_t getMaxPauseMicros() const {
+        return maxPauseMicros.load(std::memory_order_relaxed);
+    }
+
+    // Configura el pool de reciclaje (0 lo desactiva y libera lo que tenga)
+    void setRecycleCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        recycleCapacity = capacity;
+        trimLocked(capacity);
+    }
+
+    // Recorta el pool a como máximo `keep` objetos
+    void trimRecyclePool(size_t keep) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        trimLocked(keep);
+    }
+
+    size_t getRecyclePoolSize() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return recyclePool.size();
+    }
+
+    size_t getAllocatorCalls() const {
+        return allocatorCalls.load(std::memory_order_relaxed);
+    }
+
+    size_t getRecycleHits() const {
+        return recycleHits.load(std::memory_order_relaxed);
+    }
+
+    // Chunks del MPointerHeap que usa este tipo
+    size_t getSlabChunks() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        return slab->getChunkCount();
+    }
+
+    // Fragmentación del slab: fracción de los slots ya usados que hoy son huecos sin objeto vivo
+    // (0 = objetos contiguos, cerca de 1 = pocos objetos dispersos en muchos chunks)
+    double getFragmentation() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        size_t touched = slab->getTouchedSlots();
+        if (touched == 0) {
+            return 0.0;
+        }
+        return 1.0 - static_cast<double>(slab->getLiveObjects()) / static_cast<double>(touched);
+    }
+
+    unsigned getRelocationEpoch() const {
+        return relocationEpoch.load(std::memory_order_acquire);
+    }
+
+    // Compacta el heap de este tipo: mueve los objetos registrados a chunks nuevos y densos en orden de ID
+    // y actualiza la dirección de cada ID. Debe llamarse en un punto de quietud (sin otros hilos usando T):
+    // un objeto que se reserva mientras se arma la lista de movimientos queda en el slab viejo, que se suelta
+    // al final. En debug se verifica que el slab viejo termine vacío.
+    size_t compact();
+
+    // Igual que compact(), pero colocando primero los IDs de `order` (por ejemplo en orden de recorrido)
+    size_t compact(const std::vector<int>& order);
+
+    // Memoria sin construir para un T nuevo (del pool si hay, si no del allocator)
+    void* AllocateObject();
+
+    // Memoria contigua para `count` objetos nuevos (no usa el pool ni los huecos del slab)
+    std::vector<void*> AllocateObjects(size_t count);
+
+    // Devuelve memoria de AllocateObject(s) cuyo T no llegó a construirse (el constructor lanzó):
+    // vuelve al pool o al allocator y descuenta los bytes que se anotaron para el umbral de recolección
+    void ReturnObject(void* memory);
+
+    // Destruye el objeto y guarda su memoria en el pool (o la devuelve al allocator)
+    void DisposeObject(T* address);
+
+    // Igual que DisposeObject para un lote, tomando el lock del pool una sola vez
+    void DisposeObjects(const std::vector<T*>& addresses);
+
     // Registrar un nuevo MPointer
-    void Register(MPointer<T>& mpointer);
+    void Register(MPointer<T, Policy>& mpointer);
 
     // Incrementar el contador de referencias
     void IncreaseRefCount(int id);
 
+    // Incrementar/decrementar directamente sobre el nodo (modos atómico y sesgado)
+    void RetainNode(RegistryNode* node);
+    void ReleaseNode(RegistryNode* node);
+
+    // El nodo se quedó sin referencias: se libera ya (modo inmediato) o se anota para los umbrales
+    void releasedLastReference(int id) {
+        MPointerTrace::trace(MPointerTraceKind::RefCountZero, id);
+        MPOINTER_PROBE1(refcount_zero, id);
+        if (immediate.load(std::memory_order_relaxed)) {
+            reclaimNow(id);
+        } else {
+            noteZeroCount();
+        }
+    }
+
     // Decrementar el contador de referencias
     void DecreaseRefCount(int id);
 
@@ -227,73 +1667,373 @@ public:
     ~MPointerGC();
 };
 
-template <typename T>
-MPointerGC<T>* MPointerGC<T>::instance = nullptr;
+template <typename T, typename Policy>
+MPointerGC<T, Policy>* MPointerGC<T, Policy>::instance = nullptr;
 
-template <typename T>
-std::mutex MPointerGC<T>::gcMutex;
+template <typename T, typename Policy>
+std::mutex MPointerGC<T, Policy>::gcMutex;
 
-//Registro dentro del GC
-template <typename T>
-void MPointerGC<T>::Register(MPointer<T>& mpointer) {
-    auto node = memoryList.find(mpointer.ptr);
-    if (node) {
-        IncreaseRefCount(node->id);  // Incrementa el refCount si ya existe
-        mpointer.id = node->id;  // Asigna el ID existente al MPointer
+//Reservar memoria para un objeto nuevo, reutilizando primero el pool de reciclaje
+template <typename T, typename Policy>
+void* MPointerGC<T, Policy>::AllocateObject() {
+    void* recycled = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!recyclePool.empty()) {
+            recycled = recyclePool.back();
+            recyclePool.pop_back();
+            ++reusedSinceTrim;
+            recycleHits.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (recycled != nullptr) {
+        noteAllocation(sizeof(T));  // La memoria del pool ya está cobrada
+        return recycled;
+    }
+    // Se cobra sin poolMutex: si no cabe en el límite puede recolectar o esperar. Los umbrales de
+    // recolección solo cuentan la reserva si el cobro salió bien (si lanza, no se reservó nada)
+    MPointerRuntime::getInstance().charge(sizeof(T));
+    noteAllocation(sizeof(T));
+    std::lock_guard<std::mutex> lock(poolMutex);
+    allocatorCalls.fetch_add(1, std::memory_order_relaxed);
+    if constexpr (USE_SLAB) {
+        return slab->allocate();
     } else {
-        int newId;
-        memoryList.insert(mpointer.ptr, newId);  // Inserta la nueva dirección y genera un nuevo ID
-        mpointer.id = newId;  // Asigna el nuevo ID al MPointer
+        return ::operator new(sizeof(T));
+    }
+}
+
+//Reservar un bloque contiguo de objetos en chunks nuevos del slab
+template <typename T, typename Policy>
+std::vector<void*> MPointerGC<T, Policy>::AllocateObjects(size_t count) {
+    std::vector<void*> memory;
+    memory.reserve(count);
+    if constexpr (USE_SLAB) {
+        MPointerRuntime::getInstance().charge(count * sizeof(T));
+        noteAllocation(count * sizeof(T));
+        std::lock_guard<std::mutex> lock(poolMutex);
+        allocatorCalls.fetch_add(count, std::memory_order_relaxed);
+        slab->allocateRun(count, memory);
+    } else {
+        // Sin slab el bloque no puede ser contiguo, cada objeto se reserva por separado
+        for (size_t i = 0; i < count; i++) {
+            memory.push_back(AllocateObject());
+        }
+    }
+    return memory;
+}
+
+//Devolver memoria sin objeto (el constructor de T lanzó una excepción)
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::ReturnObject(void* memory) {
+    size_t bytes = bytesSinceCollection.load(std::memory_order_relaxed);
+    while (!bytesSinceCollection.compare_exchange_weak(bytes, bytes > sizeof(T) ? bytes - sizeof(T) : 0,
+                                                       std::memory_order_relaxed)) {
+    }
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (recyclePool.size() < recycleCapacity) {
+        recyclePool.push_back(memory);  // La memoria del pool sigue cobrada en el MPointerRuntime
+        return;
+    }
+    releaseStorageLocked(memory);
+}
+
+//Destruir el objeto y reciclar su memoria si el pool tiene espacio
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::DisposeObject(T* address) {
+    if (deferIfWalking(&address, 1)) {
+        return;  // Hay un forEachLive en curso: se destruye cuando termine
+    }
+    address->~T();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (recyclePool.size() < recycleCapacity) {
+        recyclePool.push_back(address);
+        return;
+    }
+    releaseStorageLocked(address);
+}
+
+//Compactación en orden de ID
+template <typename T, typename Policy>
+size_t MPointerGC<T, Policy>::compact() {
+    return compact(std::vector<int>());
+}
+
+//Compactación: los MPointers resuelven la nueva dirección por ID gracias a la época de reubicación
+template <typename T, typename Policy>
+size_t MPointerGC<T, Policy>::compact(const std::vector<int>& order) {
+    if constexpr (!USE_SLAB) {
+        return 0;  // Los objetos grandes no viven en el slab
+    } else {
+        std::unique_lock<std::shared_mutex> relocationLock(relocationMutex);  // Espera a los forEachLive
+        std::lock_guard<std::mutex> collectLock(collectMutex);
+
+        // 1. Lista de objetos a mover: primero los del orden pedido, luego el resto por ID
+        std::vector<std::pair<int, T*>> moves;
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            std::unordered_map<int, bool> placed;
+            for (int id : order) {
+                T* address = memoryList.getAddressById(id);
+                if (address && !placed[id]) {
+                    placed[id] = true;
+                    moves.emplace_back(id, address);
+                }
+            }
+            std::vector<std::pair<int, T*>> rest;
+            memoryList.forEach([&](auto& node) {
+                if (node.address && placed.find(node.id) == placed.end()) {
+                    rest.emplace_back(node.id, node.address);
+                }
+            });
+            std::sort(rest.begin(), rest.end());
+            moves.insert(moves.end(), rest.begin(), rest.end());
+        }
+
+        // 2. Slots consecutivos en un slab nuevo (el pool pertenece al slab viejo, se vacía). El slab nuevo
+        // se instala en el mismo lock, así lo que se reserve mientras se mueven los objetos ya va ahí
+        std::unique_ptr<MPointerSlab> retired;
+        std::vector<void*> slots;
+        slots.reserve(moves.size());
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            trimLocked(0);
+            retired = std::move(slab);
+            slab = std::make_unique<MPointerSlab>(sizeof(T), alignof(T));
+            for (size_t i = 0; i < moves.size(); i++) {
+                slots.push_back(slab->allocate());
+            }
+        }
+
+        // 3. Mover los objetos (sin locks: mover un T puede copiar MPointers internos)
+        for (size_t i = 0; i < moves.size(); i++) {
+            new (slots[i]) T(std::move(*moves[i].second));
+        }
+
+        // 4. Publicar las nuevas direcciones
+        {
+            std::lock_guard<std::mutex> lock(gcMutex);
+            for (size_t i = 0; i < moves.size(); i++) {
+                memoryList.setAddressById(moves[i].first, static_cast<T*>(slots[i]));
+            }
+            relocationEpoch.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        // 5. Destruir los originales y soltar el slab viejo (sus chunks vuelven al MPointerHeap)
+        for (auto& move : moves) {
+            move.second->~T();
+        }
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            for (auto& move : moves) {
+                retired->deallocate(move.second);
+            }
+            assert(retired->getLiveObjects() == 0 && "compact() con reservas de T en curso");
+            retired.reset();
+        }
+        return moves.size();
+    }
+}
+
+//Destruir un lote de objetos (los destructores corren sin lock, la memoria se devuelve de una vez)
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::DisposeObjects(const std::vector<T*>& addresses) {
+    if (deferIfWalking(addresses.data(), addresses.size())) {
+        return;
+    }
+    for (T* address : addresses) {
+        address->~T();
+    }
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (T* address : addresses) {
+        if (recyclePool.size() < recycleCapacity) {
+            recyclePool.push_back(address);
+        } else {
+            releaseStorageLocked(address);
+        }
+    }
+}
+
+//Registro dentro del GC (solo para objetos recién creados en New)
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::Register(MPointer<T, Policy>& mpointer) {
+    uint64_t birthTime = lifetimeTiming.load(std::memory_order_relaxed) ? MPointerTrace::now() : 0;  // Fuera del lock
+    std::unique_lock<std::mutex> lock(gcMutex);
+    int newId;
+    RegistryNode* node = memoryList.insert(mpointer.ptr, newId);  // Inserta la nueva dirección y genera un nuevo ID
+    node->birthTime = birthTime;
+    node->birthCycle = collectionCount.load(std::memory_order_relaxed);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    MPointerTrace::trace(MPointerTraceKind::Register, newId);
+    MPOINTER_PROBE2(register, newId, mpointer.ptr);
+    mpointer.state.id = newId;  // Asigna el nuevo ID al MPointer
+
+    RefCountMode mode = refCountMode.load(std::memory_order_relaxed);
+    if (mode == RefCountMode::Atomic || mode == RefCountMode::Biased) {
+        mpointer.state.ctrl = node;
+        if (mode == RefCountMode::Biased) {
+            // La referencia inicial es del hilo que crea el objeto
+            node->owner = currentOwner();
+            node->refCount.store(UNMERGED, std::memory_order_relaxed);
+            node->biasedCount.store(1, std::memory_order_relaxed);
+            node->merged.store(false, std::memory_order_relaxed);
+        }
+    }
+    if (generational) {
+        nursery.push_back(newId);  // Todo objeto nuevo empieza en la generación joven
+    }
+    lock.unlock();
+    if (mode == RefCountMode::Biased && localQueue != nullptr && localQueue->pending.load(std::memory_order_acquire)) {
+        processMergeQueue();  // Fuera de gcMutex: un merge puede liberar objetos
     }
 }
 
 //Aumnetar el refCount
-template <typename T>
-void MPointerGC<T>::IncreaseRefCount(int id) {
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::IncreaseRefCount(int id) {
+    MPOINTER_PROBE1(refcount_inc, id);
+    if (refCountMode.load(std::memory_order_relaxed) == RefCountMode::Deferred) {
+        logRefCount(id, +1);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(gcMutex);
     int refCount = memoryList.getRefCountById(id);
     memoryList.setRefCountById(id, refCount + 1);  // Incrementa el refCount
 }
 
 //Disminuir el refCount
-template <typename T>
-void MPointerGC<T>::DecreaseRefCount(int id) {
-    int refCount = memoryList.getRefCountById(id);
-    if (refCount > 0) {
-        memoryList.setRefCountById(id, refCount - 1);  // Decrementa el refCount
-        //std::cout << "Decreasing refCount for ID: " << id << " to " << refCount - 1 << std::endl;
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::DecreaseRefCount(int id) {
+    if (refCountMode.load(std::memory_order_relaxed) == RefCountMode::Deferred) {
+        logRefCount(id, -1);
+        return;
+    }
+    bool reachedZero = false;
+    {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        int refCount = memoryList.getRefCountById(id);
+        if (refCount > 0) {
+            memoryList.setRefCountById(id, refCount - 1);  // Decrementa el refCount
+            reachedZero = refCount == 1;
+        }
+    }
+    if (reachedZero) {
+        MPointerTrace::trace(MPointerTraceKind::RefCountZero, id);
+        MPOINTER_PROBE1(refcount_zero, id);
+        if (immediate.load(std::memory_order_relaxed)) {
+            reclaimNow(id);
+        } else {
+            noteZeroCount();
+        }
+    }
+}
+
+//Incremento sin lock: el dueño usa su contador sesgado, el resto el atómico
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::RetainNode(RegistryNode* node) {
+    MPOINTER_PROBE1(refcount_inc, node->id);
+    if (node->owner == localOwnerId && !node->merged.load(std::memory_order_relaxed)) {
+        uint64_t biased = node->biasedCount.load(std::memory_order_relaxed);
+        node->biasedCount.store(biased + BIASED_WRITE + 1, std::memory_order_relaxed);  // Sin RMW
+        return;
+    }
+    node->refCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+//Decremento sin lock; el RMW que deja refCount en 0 decide la liberación y es el último acceso al nodo
+//(en modo inmediato otro hilo puede liberarlo apenas se suelte la referencia)
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::ReleaseNode(RegistryNode* node) {
+    int id = node->id;
+    if (node->owner == localOwnerId && !node->merged.load(std::memory_order_relaxed)) {
+        uint64_t biased = node->biasedCount.load(std::memory_order_relaxed) + BIASED_WRITE - 1;
+        if (biasedReferences(biased) != 0) {
+            node->biasedCount.store(biased, std::memory_order_relaxed);  // Sin RMW
+            return;
+        }
+        // Última referencia del dueño: hace el merge él mismo (merged se publica antes que el 0 para el GC)
+        node->merged.store(true, std::memory_order_relaxed);
+        node->biasedCount.store(biased, std::memory_order_release);
+        if (node->refCount.fetch_sub(UNMERGED, std::memory_order_acq_rel) == UNMERGED) {
+            releasedLastReference(id);
+        }
+        if (localQueue->pending.load(std::memory_order_acquire)) {
+            processMergeQueue();
+        }
+        return;
+    }
+    if (node->owner != 0) {
+        // Sin merge (refCount con el desplazamiento) el decremento no puede llegar a 0; si dejaría el
+        // contador compartido negativo, la referencia pasa a la cola del dueño en vez de soltarse
+        int value = node->refCount.load(std::memory_order_relaxed);
+        while (value >= UNMERGED / 2) {
+            if (value <= UNMERGED && !node->mergeRequested.load(std::memory_order_acquire) &&
+                !node->mergeRequested.exchange(true, std::memory_order_acq_rel)) {
+                requestMerge(node);
+                return;
+            }
+            if (node->refCount.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+    if (node->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        releasedLastReference(id);
     }
 }
 
 //Libera la memoria del puntero interno
-template <typename T>
-void MPointerGC<T>::FreeMemory(int id) {
-    T* address = memoryList.getAddressById(id);
+template <typename T, typename Policy>
+void MPointerGC<T, Policy>::FreeMemory(int id) {
+    T* address = nullptr;
+    uint64_t now = lifetimeTiming.load(std::memory_order_relaxed) ? MPointerTrace::now() : 0;
+    {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        RegistryNode* node = memoryList.findById(id);
+        if (node != nullptr) {
+            address = node->address;
+            recordLifetime(*node, now);
+            memoryList.remove(node);  // Se quita de la lista antes de reciclar, la dirección puede volver a usarse
+            frees.fetch_add(1, std::memory_order_relaxed);
+            MPointerTrace::trace(MPointerTraceKind::Free, id);
+            MPOINTER_PROBE1(free, id);
+        }
+    }
     if (address) {
-        std::cout << "Liberando memoria para ID: " << id << std::endl;
-        delete address;  // Libera la memoria asignada
+        DisposeObject(address);  // Libera (o recicla) la memoria asignada
     }
-    memoryList.remove(id);  // Elimina el nodo de la lista de memoria
-    //std::cout << "Memoria para ID: " << id << " fue liberada y removida de la lista" << std::endl;
 }
 
 
 //Destructor, en caso de que el Thread no haya limpiado la memoria y el programa pare
-template <typename T>
-MPointerGC<T>::~MPointerGC() {
-    running = false;  // Detiene el hilo
-    if (gcThread.joinable()) {
-        gcThread.join();  // Espera a que el hilo termine
+template <typename T, typename Policy>
+MPointerGC<T, Policy>::~MPointerGC() {
+    {
+        std::lock_guard<std::mutex> lock(triggerMutex);
+        running = false;  // Detiene el hilo
+    }
+    triggerCv.notify_one();
+    MPointerRuntime::getInstance().unregisterCollector(this);
+    {
+        std::lock_guard<std::mutex> threadLock(threadMutex);
+        if (gcThread.joinable()) {
+            gcThread.join();  // Espera a que el hilo termine (en modo manual no hay hilo)
+        }
     }
-
-    std::cout << "Liberando todos los recursos en MPointerGC destructor." << std::endl;
 
     // Limpia toda la memoria restante si no fue liberada previamente
-    for (int id = 1; id <= memoryList.getCurrentId(); ++id) {
-        int refCount = memoryList.getRefCountById(id);
-        if (refCount == 0) {
-            FreeMemory(id);  // Libera la memoria para cualquier ID que aún no haya sido liberado
-        }
+    std::vector<T*> garbage;
+    {
+        std::lock_guard<std::mutex> lock(gcMutex);
+        collectGarbageLocked(garbage);
+    }
+    for (T* address : garbage) {
+        DisposeObject(address);
     }
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    trimLocked(0);
 }
 
 #endif  // MPOINTER_H
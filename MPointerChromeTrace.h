@@ -0,0 +1,128 @@
+#ifndef MPOINTERCHROMETRACE_H
+#define MPOINTERCHROMETRACE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MPointerTrace.h"
+
+// Exporta los eventos de MPointerTrace en el formato JSON de Chrome trace events
+// (se abre con chrome://tracing o https://ui.perfetto.dev).
+// Mientras el objeto existe el tracer queda activo y un hilo drena los buffers al archivo cada `interval`;
+// el destructor apaga el tracer, escribe lo que falte y cierra el JSON.
+//   - Ciclos de recolección, rebanadas del barrido y recolecciones de emergencia: eventos de duración (B/E)
+//   - New, registro, refCount en 0 y liberaciones: eventos instantáneos (i)
+class MPointerChromeTrace {
+private:
+    std::FILE* file;
+    bool first = true;  // Sin coma antes del primer evento
+    uint64_t baseTicks;  // Marca de tiempo que corresponde a ts = 0
+    double ticksPerMicro;  // Marcas del tracer (TSC o ns) por microsegundo, de MPointerTrace::ticksPerMicro()
+    std::chrono::milliseconds interval;
+    std::mutex writerMutex;  // Un solo escritor del archivo (el hilo o el destructor)
+    std::mutex wakeupMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+    std::thread thread;
+
+    static const char* nameOf(MPointerTraceKind kind) {
+        switch (kind) {
+            case MPointerTraceKind::New: return "New";
+            case MPointerTraceKind::Register: return "Register";
+            case MPointerTraceKind::RefCountZero: return "refCount 0";
+            case MPointerTraceKind::SweepStart:
+            case MPointerTraceKind::SweepEnd: return "collection";
+            case MPointerTraceKind::Free: return "free";
+            case MPointerTraceKind::SliceStart:
+            case MPointerTraceKind::SliceEnd: return "sweep slice";
+            case MPointerTraceKind::EmergencyStart:
+            case MPointerTraceKind::EmergencyEnd: return "emergency collection";
+        }
+        return "unknown";
+    }
+
+    static char phaseOf(MPointerTraceKind kind) {
+        switch (kind) {
+            case MPointerTraceKind::SweepStart:
+            case MPointerTraceKind::SliceStart:
+            case MPointerTraceKind::EmergencyStart: return 'B';
+            case MPointerTraceKind::SweepEnd:
+            case MPointerTraceKind::SliceEnd:
+            case MPointerTraceKind::EmergencyEnd: return 'E';
+            default: return 'i';
+        }
+    }
+
+    // Escribe los eventos drenados (requiere writerMutex)
+    void writeEvents(const std::vector<MPointerTraceEvent>& events) {
+        for (const MPointerTraceEvent& event : events) {
+            double ts = event.timestamp >= baseTicks ? (event.timestamp - baseTicks) / ticksPerMicro : 0.0;
+            char phase = phaseOf(event.kind);
+            std::fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"mpointer\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                         first ? "" : ",", nameOf(event.kind), phase, ts, static_cast<unsigned>(event.thread));
+            if (phase == 'i') {
+                std::fprintf(file, ",\"s\":\"t\"");
+            }
+            std::fprintf(file, ",\"args\":{\"id\":%d,\"arg\":%llu}}", event.id,
+                         static_cast<unsigned long long>(event.arg));
+            first = false;
+        }
+    }
+
+    void flush() {
+        std::vector<MPointerTraceEvent> events;
+        MPointerTrace::drain(events);
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writeEvents(events);
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeupMutex);
+        while (!stopping) {
+            wakeup.wait_for(lock, interval, [this]() { return stopping; });
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+public:
+    explicit MPointerChromeTrace(const std::string& path,
+                                 std::chrono::milliseconds period = std::chrono::milliseconds(50))
+        : file(std::fopen(path.c_str(), "w")), interval(period) {
+        if (file == nullptr) {
+            throw std::runtime_error("MPointerChromeTrace: no se pudo abrir " + path);
+        }
+        ticksPerMicro = MPointerTrace::ticksPerMicro();
+        std::vector<MPointerTraceEvent> old;
+        MPointerTrace::drain(old);  // Lo que quedó de antes no pertenece a esta traza
+        baseTicks = MPointerTrace::now();
+        std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        MPointerTrace::setEnabled(true);
+        thread = std::thread(&MPointerChromeTrace::run, this);
+    }
+
+    MPointerChromeTrace(const MPointerChromeTrace&) = delete;
+    MPointerChromeTrace& operator=(const MPointerChromeTrace&) = delete;
+
+    ~MPointerChromeTrace() {
+        MPointerTrace::setEnabled(false);
+        {
+            std::lock_guard<std::mutex> lock(wakeupMutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        thread.join();
+        flush();
+        std::fprintf(file, "\n]}\n");
+        std::fclose(file);
+    }
+};
+
+#endif // MPOINTERCHROMETRACE_H
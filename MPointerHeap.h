@@ -0,0 +1,394 @@
+#ifndef MPOINTERHEAP_H
+#define MPOINTERHEAP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Heap de chunks para MPointers.
+// Reserva bloques de CHUNK_SIZE alineados con mmap (pueden usar transparent huge pages)
+// y, cuando un chunk queda vacío, lo guarda en una caché; si pasa más del periodo de inactividad
+// sin reutilizarse, sus páginas se devuelven al sistema operativo con madvise.
+class MPointerHeap {
+public:
+    static constexpr size_t CHUNK_SIZE = size_t(2) << 20;  // 2 MiB, el tamaño de una huge page en x86-64
+
+    // Cómo se devuelven las páginas de un chunk inactivo
+    enum class ReturnMode {
+        DontNeed,  // MADV_DONTNEED: el RSS baja de inmediato
+        Free       // MADV_FREE: el kernel las reclama solo si hay presión de memoria
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Chunk vacío en la caché
+    struct CachedChunk {
+        void* base;
+        Clock::time_point releasedAt;
+        bool returned;  // Sus páginas ya se devolvieron al sistema operativo
+    };
+
+    std::mutex heapMutex;
+    std::vector<CachedChunk> cache;  // Chunks vacíos listos para reutilizar
+    bool hugePages = false;
+    ReturnMode returnMode = ReturnMode::DontNeed;
+    std::chrono::milliseconds idlePeriod{1000};
+
+    std::atomic<size_t> mappedBytes{0};     // Memoria virtual reservada
+    std::atomic<size_t> residentBytes{0};   // Chunks en uso o en caché sin devolver (cota superior del RSS)
+    std::atomic<size_t> returnedBytes{0};   // Total acumulado devuelto al sistema operativo
+
+    MPointerHeap() = default;
+
+    // Reserva un chunk nuevo alineado a CHUNK_SIZE
+    void* mapChunk() {
+#ifdef __linux__
+        // Se pide el doble y se recorta para que el chunk quede alineado (requisito de las huge pages)
+        size_t length = CHUNK_SIZE * 2;
+        void* raw = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        uintptr_t end = aligned + CHUNK_SIZE;
+        if (start + length > end) {
+            munmap(reinterpret_cast<void*>(end), start + length - end);
+        }
+        void* chunk = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        if (hugePages) {
+            madvise(chunk, CHUNK_SIZE, MADV_HUGEPAGE);  // Si THP no está disponible simplemente se ignora
+        }
+#endif
+        return chunk;
+#else
+        void* chunk = std::aligned_alloc(CHUNK_SIZE, CHUNK_SIZE);
+        if (chunk == nullptr) {
+            throw std::bad_alloc();
+        }
+        return chunk;
+#endif
+    }
+
+    // Devuelve al sistema operativo las páginas de un chunk que sigue reservado (requiere heapMutex)
+    void returnPages(CachedChunk& chunk) {
+#ifdef __linux__
+        int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+        if (returnMode == ReturnMode::Free) {
+            advice = MADV_FREE;
+        }
+#endif
+        if (madvise(chunk.base, CHUNK_SIZE, advice) != 0) {
+            return;
+        }
+#endif
+        chunk.returned = true;
+        residentBytes -= CHUNK_SIZE;
+        returnedBytes += CHUNK_SIZE;
+    }
+
+public:
+    MPointerHeap(const MPointerHeap&) = delete;
+    MPointerHeap& operator=(const MPointerHeap&) = delete;
+
+    // Heap único del proceso (nunca se destruye, los GC lo pueden usar hasta el final)
+    static MPointerHeap& getInstance() {
+        static MPointerHeap* heap = new MPointerHeap();
+        return *heap;
+    }
+
+    // Pide transparent huge pages para los chunks nuevos (madvise(MADV_HUGEPAGE))
+    void setHugePages(bool enabled) {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        hugePages = enabled;
+    }
+
+    // Tiempo que un chunk vacío espera en la caché antes de devolver sus páginas
+    void setIdlePeriod(std::chrono::milliseconds period) {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        idlePeriod = period;
+    }
+
+    void setReturnMode(ReturnMode mode) {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        returnMode = mode;
+    }
+
+    // Obtener un chunk (primero de la caché, si no con mmap)
+    void* acquireChunk() {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        if (!cache.empty()) {
+            CachedChunk chunk = cache.back();
+            cache.pop_back();
+            if (chunk.returned) {
+                residentBytes += CHUNK_SIZE;
+#ifdef MADV_HUGEPAGE
+                if (hugePages) {
+                    madvise(chunk.base, CHUNK_SIZE, MADV_HUGEPAGE);
+                }
+#endif
+            }
+            return chunk.base;
+        }
+        void* chunk = mapChunk();
+        mappedBytes += CHUNK_SIZE;
+        residentBytes += CHUNK_SIZE;
+        return chunk;
+    }
+
+    // Devolver un chunk vacío a la caché
+    void releaseChunk(void* chunk) {
+        {
+            std::lock_guard<std::mutex> lock(heapMutex);
+            cache.push_back({chunk, Clock::now(), false});
+        }
+        releaseIdleChunks();
+    }
+
+    // Devuelve al sistema operativo los chunks que llevan más del periodo de inactividad en la caché
+    void releaseIdleChunks() {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        Clock::time_point now = Clock::now();
+        for (CachedChunk& chunk : cache) {
+            if (!chunk.returned && now - chunk.releasedAt >= idlePeriod) {
+                returnPages(chunk);
+            }
+        }
+    }
+
+    size_t getMappedBytes() const {
+        return mappedBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t getResidentBytes() const {
+        return residentBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t getReturnedBytes() const {
+        return returnedBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t getCachedChunks() {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        return cache.size();
+    }
+
+    // RSS real del proceso según /proc/self/statm (0 si no está disponible)
+    static size_t getProcessResidentBytes() {
+#ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        size_t pages = 0;
+        size_t resident = 0;
+        if (statm >> pages >> resident) {
+            return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0;
+    }
+};
+
+// Slab de objetos de un mismo tamaño sobre chunks del MPointerHeap.
+// Cada chunk empieza con un encabezado; como los chunks están alineados a CHUNK_SIZE,
+// el encabezado de cualquier objeto se encuentra enmascarando su dirección.
+// No es thread-safe: quien lo usa debe protegerlo.
+class MPointerSlab {
+private:
+    struct ChunkHeader {
+        ChunkHeader* prev;   // Lista de chunks con espacio libre
+        ChunkHeader* next;
+        ChunkHeader* allPrev;  // Lista de todos los chunks del slab (para devolverlos en el destructor)
+        ChunkHeader* allNext;
+        void* freeList;      // Slots liberados (lista intrusiva)
+        size_t bumpSlot;     // Primer slot nunca usado
+        size_t liveSlots;    // Slots ocupados
+        bool available;      // Está en la lista de chunks con espacio
+    };
+
+    size_t slotSize;
+    size_t firstSlotOffset;
+    size_t slotsPerChunk;
+    ChunkHeader* availableChunks = nullptr;
+    ChunkHeader* allChunks = nullptr;
+    size_t chunkCount = 0;
+    size_t liveObjects = 0;
+    size_t touchedSlots = 0;  // Slots usados alguna vez en los chunks actuales (vivos + huecos)
+
+    static ChunkHeader* headerOf(void* slot) {
+        return reinterpret_cast<ChunkHeader*>(reinterpret_cast<uintptr_t>(slot) & ~(MPointerHeap::CHUNK_SIZE - 1));
+    }
+
+    void pushAvailable(ChunkHeader* chunk) {
+        chunk->prev = nullptr;
+        chunk->next = availableChunks;
+        if (availableChunks) {
+            availableChunks->prev = chunk;
+        }
+        availableChunks = chunk;
+        chunk->available = true;
+    }
+
+    void removeAvailable(ChunkHeader* chunk) {
+        if (chunk->prev) {
+            chunk->prev->next = chunk->next;
+        } else {
+            availableChunks = chunk->next;
+        }
+        if (chunk->next) {
+            chunk->next->prev = chunk->prev;
+        }
+        chunk->available = false;
+    }
+
+    // Chunk nuevo del heap, vacío y en la lista de disponibles
+    ChunkHeader* newChunk() {
+        ChunkHeader* chunk = static_cast<ChunkHeader*>(MPointerHeap::getInstance().acquireChunk());
+        chunk->freeList = nullptr;
+        chunk->bumpSlot = 0;
+        chunk->liveSlots = 0;
+        chunk->allPrev = nullptr;
+        chunk->allNext = allChunks;
+        if (allChunks) {
+            allChunks->allPrev = chunk;
+        }
+        allChunks = chunk;
+        pushAvailable(chunk);
+        ++chunkCount;
+        return chunk;
+    }
+
+public:
+    // Tamaño máximo de objeto que vale la pena guardar en un slab
+    static constexpr size_t MAX_OBJECT_SIZE = MPointerHeap::CHUNK_SIZE / 16;
+
+    MPointerSlab(size_t objectSize, size_t alignment) {
+        size_t align = alignment < alignof(void*) ? alignof(void*) : alignment;
+        size_t size = objectSize < sizeof(void*) ? sizeof(void*) : objectSize;
+        slotSize = (size + align - 1) / align * align;
+        firstSlotOffset = (sizeof(ChunkHeader) + align - 1) / align * align;
+        slotsPerChunk = (MPointerHeap::CHUNK_SIZE - firstSlotOffset) / slotSize;
+    }
+
+    MPointerSlab(const MPointerSlab&) = delete;
+    MPointerSlab& operator=(const MPointerSlab&) = delete;
+
+    // Devuelve todos los chunks al MPointerHeap (los objetos que sigan ahí ya deben estar destruidos)
+    ~MPointerSlab() {
+        ChunkHeader* chunk = allChunks;
+        while (chunk != nullptr) {
+            ChunkHeader* next = chunk->allNext;
+            MPointerHeap::getInstance().releaseChunk(chunk);
+            chunk = next;
+        }
+    }
+
+    void* allocate() {
+        if (availableChunks == nullptr) {
+            newChunk();
+        }
+
+        ChunkHeader* chunk = availableChunks;
+        void* slot;
+        if (chunk->freeList) {
+            slot = chunk->freeList;
+            chunk->freeList = *static_cast<void**>(slot);
+        } else {
+            slot = reinterpret_cast<char*>(chunk) + firstSlotOffset + chunk->bumpSlot * slotSize;
+            ++chunk->bumpSlot;
+            ++touchedSlots;
+        }
+        ++chunk->liveSlots;
+        ++liveObjects;
+
+        if (chunk->freeList == nullptr && chunk->bumpSlot == slotsPerChunk) {
+            removeAvailable(chunk);  // Chunk lleno
+        }
+        return slot;
+    }
+
+    // Reserva `count` slots consecutivos en chunks nuevos (sin usar huecos de chunks existentes)
+    void allocateRun(size_t count, std::vector<void*>& slots) {
+        while (count > 0) {
+            ChunkHeader* chunk = newChunk();
+            size_t run = count < slotsPerChunk ? count : slotsPerChunk;
+            char* first = reinterpret_cast<char*>(chunk) + firstSlotOffset;
+            for (size_t i = 0; i < run; i++) {
+                slots.push_back(first + i * slotSize);
+            }
+            chunk->bumpSlot = run;
+            chunk->liveSlots = run;
+            liveObjects += run;
+            touchedSlots += run;
+            if (run == slotsPerChunk) {
+                removeAvailable(chunk);
+            }
+            count -= run;
+        }
+    }
+
+    void deallocate(void* slot) {
+        ChunkHeader* chunk = headerOf(slot);
+        *static_cast<void**>(slot) = chunk->freeList;
+        chunk->freeList = slot;
+        --chunk->liveSlots;
+        --liveObjects;
+
+        if (chunk->liveSlots == 0) {
+            // Chunk vacío: vuelve al heap (que lo devolverá al sistema operativo si sigue inactivo)
+            if (chunk->available) {
+                removeAvailable(chunk);
+            }
+            if (chunk->allPrev) {
+                chunk->allPrev->allNext = chunk->allNext;
+            } else {
+                allChunks = chunk->allNext;
+            }
+            if (chunk->allNext) {
+                chunk->allNext->allPrev = chunk->allPrev;
+            }
+            --chunkCount;
+            touchedSlots -= chunk->bumpSlot;
+            MPointerHeap::getInstance().releaseChunk(chunk);
+        } else if (!chunk->available) {
+            pushAvailable(chunk);
+        }
+    }
+
+    size_t getChunkCount() const {
+        return chunkCount;
+    }
+
+    size_t getLiveObjects() const {
+        return liveObjects;
+    }
+
+    size_t getTouchedSlots() const {
+        return touchedSlots;
+    }
+
+    size_t getSlotsPerChunk() const {
+        return slotsPerChunk;
+    }
+
+    size_t getSlotSize() const {
+        return slotSize;
+    }
+};
+
+#endif // MPOINTERHEAP_H
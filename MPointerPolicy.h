@@ -0,0 +1,68 @@
+#ifndef MPOINTERPOLICY_H
+#define MPOINTERPOLICY_H
+
+#include <atomic>
+#include <type_traits>
+
+// Políticas de compilación para MPointer<T, Policy> y MPointerGC<T, Policy>.
+// Se resuelven con if constexpr: lo que una política no usa no se compila (ni mutex, ni registro, ni GC).
+
+// Modelo de hilos de los contadores de referencias
+enum class MPointerThreading {
+    SingleThreaded,  // Contador normal (los MPointers no se comparten entre hilos)
+    MultiThreaded    // Contador atómico, o el GC con sus modos de conteo
+};
+
+// Quién libera los objetos
+enum class MPointerReclamation {
+    Collector,  // Registro en MPointerGC y sus modos en tiempo de ejecución (hilo, manual, inmediato, ...)
+    Counted     // Sin registro ni GC: el objeto se destruye al soltar la última referencia
+};
+
+// De dónde sale la memoria
+enum class MPointerAllocator {
+    Default,  // Slab/pool del GC con Collector (o la región activa, si hay); operator new con Counted
+    Region    // Siempre el MPointerScope activo: sin contador ni registro
+};
+
+template <MPointerThreading Threading, MPointerReclamation Reclamation,
+          MPointerAllocator Allocator = MPointerAllocator::Default>
+struct MPointerPolicy {
+    static constexpr MPointerThreading threading = Threading;
+    static constexpr MPointerReclamation reclamation = Reclamation;
+    static constexpr MPointerAllocator allocator = Allocator;
+
+    static constexpr bool collected = Reclamation == MPointerReclamation::Collector &&
+                                      Allocator == MPointerAllocator::Default;
+    static constexpr bool counted = Reclamation == MPointerReclamation::Counted &&
+                                    Allocator == MPointerAllocator::Default;
+    static constexpr bool regionOnly = Allocator == MPointerAllocator::Region;
+
+    // El GC trabaja con su propio hilo, así que no tiene versión de un solo hilo
+    static_assert(Reclamation != MPointerReclamation::Collector || Allocator == MPointerAllocator::Region ||
+                  Threading == MPointerThreading::MultiThreaded,
+                  "MPointerGC necesita MPointerThreading::MultiThreaded");
+};
+
+// Comportamiento original: registro en MPointerGC
+using MPointerDefaultPolicy = MPointerPolicy<MPointerThreading::MultiThreaded, MPointerReclamation::Collector>;
+
+// Puntero + contador normal, sin mutex ni registro (un solo hilo)
+using MPointerSingleThreadedPolicy = MPointerPolicy<MPointerThreading::SingleThreaded, MPointerReclamation::Counted>;
+
+// Puntero + contador atómico, sin registro (como std::shared_ptr)
+using MPointerAtomicPolicy = MPointerPolicy<MPointerThreading::MultiThreaded, MPointerReclamation::Counted>;
+
+// Solo el MPointerScope activo: un puntero crudo que vive hasta que termina la región
+using MPointerRegionPolicy = MPointerPolicy<MPointerThreading::SingleThreaded, MPointerReclamation::Counted,
+                                            MPointerAllocator::Region>;
+
+// Bloque de un objeto con conteo directo: el contador va junto al objeto (una sola reserva)
+template <typename T, typename Policy>
+struct MPointerCountedBlock {
+    using Counter = std::conditional_t<Policy::threading == MPointerThreading::MultiThreaded, std::atomic<long>, long>;
+    Counter refs{1};
+    T value{};
+};
+
+#endif // MPOINTERPOLICY_H
@@ -0,0 +1,31 @@
+#ifndef MPOINTERPROBES_H
+#define MPOINTERPROBES_H
+
+// Probes USDT (provider "mpointer") para perf, bpftrace y systemtap.
+// Si existe <sys/sdt.h> (paquete systemtap-sdt-dev) cada probe es un NOP con una nota en la sección
+// .note.stapsdt del binario; sin el header, o con MPOINTER_NO_USDT, los macros no generan nada.
+//   mpointer:new(address, size)              MPointer::New reservó un objeto
+//   mpointer:register(id, address)           El objeto entró al registro del GC
+//   mpointer:refcount_inc(id)                Una copia más del MPointer
+//   mpointer:refcount_zero(id)               El refCount llegó a 0
+//   mpointer:free(id)                        El objeto salió del registro para destruirse
+//   mpointer:collect_begin(cycle)            Empieza un ciclo de recolección
+//   mpointer:collect_end(freed, micros)      Termina el ciclo (objetos liberados, duración)
+// Ejemplo de uso en mpointer.bt.
+
+#if !defined(MPOINTER_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define MPOINTER_USDT 1
+#endif
+#endif
+
+#ifdef MPOINTER_USDT
+#define MPOINTER_PROBE1(name, a) DTRACE_PROBE1(mpointer, name, a)
+#define MPOINTER_PROBE2(name, a, b) DTRACE_PROBE2(mpointer, name, a, b)
+#else
+#define MPOINTER_PROBE1(name, a) do { } while (0)
+#define MPOINTER_PROBE2(name, a, b) do { } while (0)
+#endif
+
+#endif // MPOINTERPROBES_H
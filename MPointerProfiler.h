@@ -0,0 +1,216 @@
+#ifndef MPOINTERPROFILER_H
+#define MPOINTERPROFILER_H
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>) && __has_include(<dlfcn.h>)
+#include <execinfo.h>
+#include <dlfcn.h>
+#define MPOINTER_PROFILER_BACKTRACE 1
+#endif
+#endif
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#define MPOINTER_NOINLINE __attribute__((noinline))
+#else
+#define MPOINTER_NOINLINE
+#endif
+
+// Profiler de sitios de reserva de MPointer::New por muestreo.
+// Cada hilo descuenta los bytes que reserva; cuando el contador llega a 0 se toma una muestra (backtrace) y
+// el siguiente intervalo se sortea con distribución exponencial de media `interval` (proceso de Poisson
+// sobre los bytes), así los tipos chicos y los grandes se muestrean sin sesgo. Cada muestra se pondera
+// con la cantidad de bytes que representa.
+// Apagado (interval 0) cuesta una carga relaxed por New. La salida es "folded stacks" (flamegraph.pl,
+// speedscope, inferno): "main;f;g;MPointer<T>::New bytes".
+class MPointerAllocationProfiler {
+public:
+    static constexpr size_t DEFAULT_INTERVAL = 512 * 1024;  // Bytes promedio entre muestras
+    static constexpr int MAX_FRAMES = 32;
+
+    struct Site {
+        double objects = 0;  // Objetos estimados (muestras ponderadas)
+        double bytes = 0;    // Bytes estimados
+        size_t samples = 0;  // Muestras reales
+    };
+
+private:
+    static inline std::atomic<size_t> interval{0};
+    static inline std::mutex sitesMutex;
+    // (tipo, pila) -> estimación; la pila va de la función que llamó a New hacia afuera
+    static inline std::map<std::pair<std::string, std::vector<void*>>, Site> sites;
+    static inline thread_local int64_t bytesUntilSample = 0;
+    static inline thread_local uint64_t randomState = 0;
+
+    // Siguiente intervalo (exponencial de media `mean`) con un xorshift por hilo
+    static int64_t nextInterval(size_t mean) {
+        if (randomState == 0) {
+            randomState = reinterpret_cast<uintptr_t>(&randomState) * 0x9E3779B97F4A7C15ull + 1;
+        }
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 7;
+        randomState ^= randomState << 17;
+        double uniform = ((randomState >> 11) + 0.5) / 9007199254740992.0;  // (0, 1)
+        return static_cast<int64_t>(-std::log(uniform) * static_cast<double>(mean)) + 1;
+    }
+
+    static std::string demangle(const char* name) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && readable != nullptr) {
+            std::string result(readable);
+            std::free(readable);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+    // Nombre de una dirección de retorno: símbolo exportado o módulo+offset (se resuelve con addr2line)
+    static std::string symbolize(void* address) {
+#ifdef MPOINTER_PROFILER_BACKTRACE
+        Dl_info info;
+        if (dladdr(address, &info) != 0) {
+            if (info.dli_sname != nullptr) {
+                return demangle(info.dli_sname);
+            }
+            if (info.dli_fname != nullptr) {
+                std::string module = info.dli_fname;
+                module = module.substr(module.find_last_of('/') + 1);
+                char offset[32];
+                std::snprintf(offset, sizeof(offset), "+0x%zx",
+                              static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+                return module + offset;
+            }
+        }
+#endif
+        char text[32];
+        std::snprintf(text, sizeof(text), "%p", address);
+        return text;
+    }
+
+    // Sin inline para que su marco sea siempre el primero de la pila y se pueda saltar
+    MPOINTER_NOINLINE static void record(const char* typeName, size_t size, size_t count, size_t mean) {
+        std::vector<void*> stack;
+#ifdef MPOINTER_PROFILER_BACKTRACE
+        void* frames[MAX_FRAMES + 1];
+        int depth = backtrace(frames, MAX_FRAMES + 1);
+        for (int i = 1; i < depth; i++) {
+            stack.push_back(frames[i]);
+        }
+#endif
+        // Una muestra representa los bytes que la reserva tenía probabilidad de cubrir (y sus `count` objetos)
+        double probability = 1.0 - std::exp(-static_cast<double>(size) / static_cast<double>(mean));
+        double weight = probability > 0 ? 1.0 / probability : 1.0;
+        std::lock_guard<std::mutex> lock(sitesMutex);
+        Site& site = sites[{typeName, std::move(stack)}];
+        site.objects += weight * static_cast<double>(count);
+        site.bytes += weight * static_cast<double>(size);
+        site.samples++;
+    }
+
+public:
+    // Bytes promedio entre muestras (0 apaga el profiler)
+    static void setSamplingInterval(size_t bytes) {
+#ifdef MPOINTER_PROFILER_BACKTRACE
+        if (bytes != 0) {
+            void* warmup[1];
+            backtrace(warmup, 1);  // La primera llamada carga libgcc; mejor aquí que dentro de un New
+        }
+#endif
+        interval.store(bytes, std::memory_order_relaxed);
+    }
+
+    static size_t getSamplingInterval() {
+        return interval.load(std::memory_order_relaxed);
+    }
+
+    static bool enabled() {
+        return interval.load(std::memory_order_relaxed) != 0;
+    }
+
+    // Punto de muestreo de New: descuenta `size` bytes y toma una muestra si se agotó el intervalo del hilo.
+    // NewBlock reserva `count` objetos de una vez: la muestra cuenta el bloque entero
+    template <typename T>
+    static void sample(size_t size, size_t count = 1) {
+        size_t mean = interval.load(std::memory_order_relaxed);
+        if (mean == 0) {
+            return;
+        }
+        bytesUntilSample -= static_cast<int64_t>(size);
+        if (bytesUntilSample > 0) {
+            return;
+        }
+        bool first = randomState == 0;  // El primer intervalo del hilo se sortea, no se muestrea
+        bytesUntilSample = nextInterval(mean);
+        if (!first) {
+            record(typeid(T).name(), size, count, mean);
+        }
+    }
+
+    // Copia de los sitios muestreados
+    static std::vector<std::pair<std::string, Site>> getSites() {
+        decltype(sites) copy;
+        {
+            std::lock_guard<std::mutex> lock(sitesMutex);
+            copy = sites;
+        }
+        std::vector<std::pair<std::string, Site>> result;
+        for (auto& entry : copy) {
+            result.emplace_back(foldedStack(entry.first.first, entry.first.second), entry.second);  // Sin el lock
+        }
+        return result;
+    }
+
+    static void reset() {
+        std::lock_guard<std::mutex> lock(sitesMutex);
+        sites.clear();
+    }
+
+    // Pila en formato folded: desde el marco más externo hasta el New del tipo
+    static std::string foldedStack(const std::string& typeName, const std::vector<void*>& stack) {
+        std::string folded;
+        for (size_t i = stack.size(); i-- > 0;) {
+            std::string frame = symbolize(stack[i]);
+            if (frame.find("MPointerAllocationProfiler::") != std::string::npos) {
+                continue;  // sample<T>() si no se hizo inline
+            }
+            for (char& c : frame) {
+                if (c == ';') {
+                    c = ':';  // ';' separa marcos
+                }
+            }
+            folded += frame + ";";
+        }
+        return folded + "MPointer<" + demangle(typeName.c_str()) + ">::New";
+    }
+
+    // Escribe los sitios como folded stacks con los bytes estimados (o los objetos, con `countObjects`)
+    static void writeFolded(const std::string& path, bool countObjects = false) {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (file == nullptr) {
+            throw std::runtime_error("MPointerAllocationProfiler: no se pudo abrir " + path);
+        }
+        for (auto& site : getSites()) {
+            double value = countObjects ? site.second.objects : site.second.bytes;
+            std::fprintf(file, "%s %.0f\n", site.first.c_str(), value);
+        }
+        std::fclose(file);
+    }
+};
+
+#endif // MPOINTERPROFILER_H
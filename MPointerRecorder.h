@@ -0,0 +1,310 @@
+#ifndef MPOINTERRECORDER_H
+#define MPOINTERRECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include "MPointerTrace.h"
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// Qué hizo un MPointer con un objeto del GC
+enum class MPointerRecordKind : uint8_t {
+    New = 1,     // MPointer::New / NewBlock creó el objeto (primera referencia)
+    Copy = 2,    // Un MPointer más apunta al objeto (copia o asignación)
+    Destroy = 3  // Un MPointer dejó de apuntar al objeto (destructor, asignación o nullptr)
+};
+
+// Evento de la grabación (16 bytes)
+struct MPointerRecordEvent {
+    uint64_t stamp;   // (marcas de MPointerTrace::now() desde start()) << 8 | kind
+    int32_t object;   // ID del objeto en el registro de su tipo
+    uint16_t thread;  // Número de hilo asignado por el grabador (no el TID del sistema)
+    uint16_t type;    // Índice en la tabla de tipos de la grabación
+
+    MPointerRecordKind kind() const {
+        return static_cast<MPointerRecordKind>(stamp & 0xFF);
+    }
+
+    uint64_t ticks() const {
+        return stamp >> 8;
+    }
+};
+
+static_assert(sizeof(MPointerRecordEvent) == 16, "MPointerRecordEvent debe ocupar 16 bytes");
+
+struct MPointerRecordType {
+    std::string name;
+    uint32_t size;  // sizeof(T)
+};
+
+// Grabación leída de un archivo de MPointerAllocationRecorder
+struct MPointerRecording {
+    static constexpr char MAGIC[4] = {'M', 'P', 'A', 'R'};
+    static constexpr uint32_t VERSION = 1;
+
+    double ticksPerMicro = 1;
+    std::vector<MPointerRecordType> types;
+    std::vector<MPointerRecordEvent> events;  // En el orden en que se escribieron (por hilo, no global)
+
+    // Formato: "MPAR", versión, ticksPerMicro, eventos; al final la tabla de tipos y un trailer con la
+    // posición de la tabla, la cantidad de tipos y otra vez "MPAR" (la tabla se conoce recién al detener)
+    static MPointerRecording read(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("MPointerRecording: no se pudo abrir " + path);
+        }
+        MPointerRecording recording;
+        auto fail = [&](const char* reason) {
+            std::fclose(file);
+            throw std::runtime_error(std::string("MPointerRecording: ") + reason + " en " + path);
+        };
+        char magic[4];
+        uint32_t version = 0;
+        if (std::fread(magic, 1, 4, file) != 4 || std::memcmp(magic, MAGIC, 4) != 0 ||
+            std::fread(&version, sizeof(version), 1, file) != 1 || version != VERSION ||
+            std::fread(&recording.ticksPerMicro, sizeof(double), 1, file) != 1) {
+            fail("encabezado invalido");
+        }
+        long eventsStart = std::ftell(file);
+
+        uint64_t tableOffset = 0;
+        uint32_t typeCount = 0;
+        if (std::fseek(file, -16, SEEK_END) != 0 || std::fread(&tableOffset, sizeof(tableOffset), 1, file) != 1 ||
+            std::fread(&typeCount, sizeof(typeCount), 1, file) != 1 || std::fread(magic, 1, 4, file) != 4 ||
+            std::memcmp(magic, MAGIC, 4) != 0) {
+            fail("trailer invalido (la grabacion no se detuvo)");
+        }
+        if (tableOffset < static_cast<uint64_t>(eventsStart) ||
+            (tableOffset - eventsStart) % sizeof(MPointerRecordEvent) != 0) {
+            fail("tabla de tipos fuera de lugar");
+        }
+        recording.events.resize((tableOffset - eventsStart) / sizeof(MPointerRecordEvent));
+        std::fseek(file, eventsStart, SEEK_SET);
+        if (std::fread(recording.events.data(), sizeof(MPointerRecordEvent), recording.events.size(), file) !=
+            recording.events.size()) {
+            fail("eventos truncados");
+        }
+        for (uint32_t i = 0; i < typeCount; i++) {
+            uint32_t size = 0;
+            uint32_t length = 0;
+            if (std::fread(&size, sizeof(size), 1, file) != 1 || std::fread(&length, sizeof(length), 1, file) != 1) {
+                fail("tabla de tipos truncada");
+            }
+            std::string name(length, '\0');
+            if (length != 0 && std::fread(&name[0], 1, length, file) != length) {
+                fail("tabla de tipos truncada");
+            }
+            recording.types.push_back({std::move(name), size});
+        }
+        std::fclose(file);
+        for (const MPointerRecordEvent& event : recording.events) {
+            if (event.type >= recording.types.size()) {
+                throw std::runtime_error("MPointerRecording: evento con tipo desconocido en " + path);
+            }
+        }
+        return recording;
+    }
+
+    // Ordena los eventos en orden global (por marca de tiempo; dentro de un hilo se respeta el orden original)
+    void sortByTime() {
+        std::stable_sort(events.begin(), events.end(), [](const MPointerRecordEvent& a, const MPointerRecordEvent& b) {
+            return a.ticks() < b.ticks();
+        });
+    }
+};
+
+// Grabador de la actividad de los MPointers del GC (New, copias y destrucciones) para reproducirla después
+// con mpointer_replay contra otra configuración de MPointerGC.
+// A diferencia de MPointerTrace no descarta eventos: cada hilo junta los suyos en un buffer propio y lo
+// escribe al archivo cuando se llena (o al terminar el hilo, o en stop()). Apagado cuesta una carga
+// relaxed por operación; grabando, un lock sin competencia y una lectura del TSC.
+class MPointerAllocationRecorder {
+public:
+    static constexpr size_t BUFFER_EVENTS = 4096;  // Eventos por hilo entre escrituras
+
+private:
+    struct Buffer {
+        std::mutex mutex;
+        std::vector<MPointerRecordEvent> events;
+        uint16_t thread = 0;
+        bool retired = false;  // El hilo terminó: se borra en el próximo stop()
+    };
+
+    // Registra el buffer del hilo la primera vez y lo escribe cuando el hilo termina
+    struct BufferHolder {
+        std::shared_ptr<Buffer> buffer;
+        ~BufferHolder() {
+            if (buffer) {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                flushLocked(*buffer);
+                buffer->retired = true;
+            }
+        }
+    };
+
+    static inline std::atomic<bool> active{false};
+    static inline std::atomic<uint16_t> nextThread{1};
+    static inline std::mutex buffersMutex;
+    static inline std::vector<std::shared_ptr<Buffer>> buffers;
+    static inline std::mutex fileMutex;  // Protege file, written y la tabla de tipos
+    static inline std::FILE* file = nullptr;
+    static inline uint64_t written = 0;
+    static inline std::atomic<uint64_t> startTicks{0};
+    static inline std::vector<MPointerRecordType> types;
+    static inline thread_local Buffer* localBuffer = nullptr;
+    static inline thread_local BufferHolder localHolder;
+
+    static std::string demangle(const char* name) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && readable != nullptr) {
+            std::string result(readable);
+            std::free(readable);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+    static uint16_t registerType(const char* name, size_t size) {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        types.push_back({demangle(name), static_cast<uint32_t>(size)});
+        return static_cast<uint16_t>(types.size() - 1);
+    }
+
+    // Índice del tipo en la tabla (la tabla dura todo el proceso; cada grabación la escribe completa).
+    // Cada política tiene su propio registro de IDs, así que T con otra política es otra entrada.
+    template <typename T, typename Policy>
+    static uint16_t typeIndex() {
+        static const uint16_t index = registerType(typeid(T).name(), sizeof(T));
+        return index;
+    }
+
+    static Buffer* bufferForThread() {
+        if (localBuffer == nullptr) {
+            auto buffer = std::make_shared<Buffer>();
+            buffer->thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+            buffer->events.reserve(BUFFER_EVENTS);
+            {
+                std::lock_guard<std::mutex> lock(buffersMutex);
+                buffers.push_back(buffer);
+            }
+            localHolder.buffer = buffer;
+            localBuffer = buffer.get();
+        }
+        return localBuffer;
+    }
+
+    // Escribe los eventos del buffer (con buffer.mutex tomado)
+    static void flushLocked(Buffer& buffer) {
+        if (buffer.events.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (file != nullptr) {
+            written += std::fwrite(buffer.events.data(), sizeof(MPointerRecordEvent), buffer.events.size(), file);
+        }
+        buffer.events.clear();
+    }
+
+    static void append(MPointerRecordKind kind, uint16_t type, int id) {
+        Buffer* buffer = bufferForThread();
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        uint64_t ticks = MPointerTrace::now() - startTicks.load(std::memory_order_relaxed);
+        buffer->events.push_back({(ticks << 8) | static_cast<uint8_t>(kind), id, buffer->thread, type});
+        if (buffer->events.size() >= BUFFER_EVENTS) {
+            flushLocked(*buffer);
+        }
+    }
+
+public:
+    static bool recording() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // Punto de grabación: no hace nada (ni toca el thread_local) si no se está grabando
+    template <typename T, typename Policy>
+    static void record(MPointerRecordKind kind, int id) {
+        if (recording()) {
+            append(kind, typeIndex<T, Policy>(), id);
+        }
+    }
+
+    // Empieza a grabar en `path` (lo trunca). Los objetos creados antes aparecen solo con sus copias y
+    // destrucciones; el reproductor los crea la primera vez que los ve.
+    static void start(const std::string& path) {
+        std::lock_guard<std::mutex> buffersLock(buffersMutex);
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            if (file != nullptr) {
+                throw std::logic_error("MPointerAllocationRecorder: ya hay una grabacion en curso");
+            }
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                throw std::runtime_error("MPointerAllocationRecorder: no se pudo abrir " + path);
+            }
+            double ticksPerMicro = MPointerTrace::ticksPerMicro();
+            std::fwrite(MPointerRecording::MAGIC, 1, 4, file);
+            std::fwrite(&MPointerRecording::VERSION, sizeof(uint32_t), 1, file);
+            std::fwrite(&ticksPerMicro, sizeof(double), 1, file);
+            written = 0;
+            startTicks.store(MPointerTrace::now(), std::memory_order_relaxed);
+        }
+        for (auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->events.clear();  // Restos de una grabación anterior
+        }
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    // Termina la grabación: escribe los buffers de todos los hilos y la tabla de tipos.
+    // Devuelve la cantidad de eventos grabados.
+    static uint64_t stop() {
+        active.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> buffersLock(buffersMutex);
+        for (auto& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            flushLocked(*buffer);
+        }
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [](const std::shared_ptr<Buffer>& buffer) {
+                                         std::lock_guard<std::mutex> lock(buffer->mutex);
+                                         return buffer->retired;
+                                     }),
+                      buffers.end());
+
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (file == nullptr) {
+            return 0;
+        }
+        uint64_t tableOffset = static_cast<uint64_t>(std::ftell(file));
+        for (const MPointerRecordType& type : types) {
+            uint32_t length = static_cast<uint32_t>(type.name.size());
+            std::fwrite(&type.size, sizeof(type.size), 1, file);
+            std::fwrite(&length, sizeof(length), 1, file);
+            std::fwrite(type.name.data(), 1, length, file);
+        }
+        uint32_t typeCount = static_cast<uint32_t>(types.size());
+        std::fwrite(&tableOffset, sizeof(tableOffset), 1, file);
+        std::fwrite(&typeCount, sizeof(typeCount), 1, file);
+        std::fwrite(MPointerRecording::MAGIC, 1, 4, file);
+        std::fclose(file);
+        file = nullptr;
+        return written;
+    }
+};
+
+#endif // MPOINTERRECORDER_H
@@ -0,0 +1,254 @@
+#ifndef MPOINTERRUNTIME_H
+#define MPOINTERRUNTIME_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+#include "MPointerTrace.h"
+#include "MPointerSnapshot.h"
+
+// Error de MPointer::New cuando la reserva superaría el límite del heap incluso después de la
+// recolección de emergencia (y, si se pidió, de esperar el timeout). Es un std::bad_alloc para que
+// el código que ya maneja falta de memoria no tenga que cambiar.
+class MPointerHeapLimitExceeded : public std::bad_alloc {
+public:
+    const char* what() const noexcept override {
+        return "MPointer: se alcanzó el límite del heap";
+    }
+};
+
+// Contabilidad global de la memoria de los MPointerGC del proceso y límite del heap.
+// Cada GC cobra aquí la memoria que pide al allocator y la devuelve al liberarla; también se cobran los
+// bloques de las regiones (MPointerScope) y los de la política contada (MPointerCountedBlock). Si una reserva
+// superaría el límite se ejecuta una recolección de emergencia sincrónica en todos los GC registrados;
+// si aun así no alcanza, según la política se espera a que otro hilo libere memoria o se lanza
+// MPointerHeapLimitExceeded.
+class MPointerRuntime {
+public:
+    // Qué hacer cuando la recolección de emergencia no libera lo suficiente
+    enum class LimitPolicy {
+        Fail,  // Lanzar MPointerHeapLimitExceeded de inmediato
+        Block  // Esperar hasta `timeout` a que se libere memoria y luego lanzar
+    };
+
+private:
+    // Lo que cada MPointerGC registra al crearse
+    struct Collector {
+        const void* owner;
+        std::function<void()> collect;                     // Recolección de emergencia
+        std::function<void(MPointerHeapSnapshot&)> snapshot;  // Objetos vivos para el snapshot del heap
+    };
+
+    std::mutex runtimeMutex;  // Protege collectors, la política y la espera
+    std::condition_variable released;  // Avisa a los hilos bloqueados que se liberó memoria
+    std::vector<Collector> collectors;
+    LimitPolicy policy = LimitPolicy::Fail;
+    std::chrono::milliseconds timeout{0};
+
+    std::atomic<size_t> heapLimit{0};  // 0 = sin límite
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> peakBytes{0};
+    std::atomic<size_t> waiters{0};    // Hilos esperando memoria (para no pagar el notify sin esperas)
+    std::atomic<size_t> throttledAllocations{0};  // Reservas que tuvieron que recolectar o esperar
+    std::atomic<size_t> failedAllocations{0};     // Reservas que terminaron en MPointerHeapLimitExceeded
+    std::atomic<size_t> emergencyCollections{0};
+    std::atomic<size_t> blockedMicros{0};         // Tiempo total esperando memoria
+
+    static inline thread_local bool collecting = false;  // El hilo está dentro de una recolección
+
+    MPointerRuntime() = default;
+
+    // Cobra `bytes` si caben dentro del límite
+    bool tryCharge(size_t bytes) {
+        size_t limit = heapLimit.load(std::memory_order_relaxed);
+        size_t current = liveBytes.load(std::memory_order_relaxed);
+        do {
+            if (limit != 0 && current + bytes > limit) {
+                return false;
+            }
+        } while (!liveBytes.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+        size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (current + bytes > peak &&
+               !peakBytes.compare_exchange_weak(peak, current + bytes, std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+public:
+    // Ejecuta la recolección de todos los GC registrados. Se hacen dos pasadas: la segunda recoge lo que
+    // soltaron los destructores de la primera y los decrementos diferidos que el GC retiene un ciclo.
+    void collectAll() {
+        std::vector<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(runtimeMutex);
+            for (auto& collector : collectors) {
+                pending.push_back(collector.collect);
+            }
+        }
+        CollectingScope scope;
+        for (int pass = 0; pass < 2; pass++) {
+            for (auto& collect : pending) {
+                collect();
+            }
+        }
+    }
+
+    // Marca al hilo como recolector mientras dura: un New() desde un destructor que corre dentro de una
+    // recolección no puede pedir otra (se bloquearía en el collectMutex de su propio GC)
+    struct CollectingScope {
+        bool previous;
+        CollectingScope() : previous(collecting) {
+            collecting = true;
+        }
+        ~CollectingScope() {
+            collecting = previous;
+        }
+    };
+
+    // El hilo actual está dentro de una recolección
+    static bool isCollecting() {
+        return collecting;
+    }
+
+    MPointerRuntime(const MPointerRuntime&) = delete;
+    MPointerRuntime& operator=(const MPointerRuntime&) = delete;
+
+    // Runtime único del proceso (nunca se destruye, igual que MPointerHeap)
+    static MPointerRuntime& getInstance() {
+        static MPointerRuntime* runtime = new MPointerRuntime();
+        return *runtime;
+    }
+
+    // Límite de memoria para los objetos de todos los MPointerGC, las regiones y los bloques contados
+    // (0 = sin límite). La recolección de emergencia solo puede liberar objetos de los GC: una región suelta
+    // su memoria al cerrar el scope y un bloque contado cuando se va su última referencia.
+    void setHeapLimit(size_t bytes, LimitPolicy limitPolicy = LimitPolicy::Fail,
+                      std::chrono::milliseconds blockTimeout = std::chrono::milliseconds(0)) {
+        {
+            std::lock_guard<std::mutex> lock(runtimeMutex);
+            policy = limitPolicy;
+            timeout = blockTimeout;
+            heapLimit.store(bytes, std::memory_order_relaxed);
+        }
+        released.notify_all();  // Con un límite más alto puede que los bloqueados ya quepan
+    }
+
+    // Cada MPointerGC registra su recolección de emergencia (y su parte del snapshot) al crearse
+    void registerCollector(const void* owner, std::function<void()> collect,
+                           std::function<void(MPointerHeapSnapshot&)> snapshot = nullptr) {
+        std::lock_guard<std::mutex> lock(runtimeMutex);
+        collectors.push_back({owner, std::move(collect), std::move(snapshot)});
+    }
+
+    void unregisterCollector(const void* owner) {
+        std::lock_guard<std::mutex> lock(runtimeMutex);
+        for (auto it = collectors.begin(); it != collectors.end(); ++it) {
+            if (it->owner == owner) {
+                collectors.erase(it);
+                return;
+            }
+        }
+    }
+
+    // Snapshot de los objetos vivos de todos los GC registrados (cada GC toma su lock por rebanadas)
+    MPointerHeapSnapshot captureHeapSnapshot() {
+        std::vector<std::function<void(MPointerHeapSnapshot&)>> pending;
+        {
+            std::lock_guard<std::mutex> lock(runtimeMutex);
+            for (auto& collector : collectors) {
+                if (collector.snapshot) {
+                    pending.push_back(collector.snapshot);
+                }
+            }
+        }
+        MPointerHeapSnapshot snapshot;
+        for (auto& capture : pending) {
+            capture(snapshot);
+        }
+        return snapshot;
+    }
+
+    // Escribe el snapshot del heap en `path` (el archivo se escribe sin ningún lock tomado);
+    // se analiza con mpointer_heap_analyzer
+    void writeHeapSnapshot(const std::string& path) {
+        captureHeapSnapshot().write(path);
+    }
+
+    // Cobra una reserva; si no cabe recolecta, espera o lanza según la política
+    void charge(size_t bytes) {
+        if (tryCharge(bytes)) {
+            return;
+        }
+        throttledAllocations.fetch_add(1, std::memory_order_relaxed);
+        // Una reserva hecha desde un destructor que corre dentro de una recolección no puede recolectar otra vez
+        if (!collecting) {
+            emergencyCollections.fetch_add(1, std::memory_order_relaxed);
+            MPointerTrace::trace(MPointerTraceKind::EmergencyStart, 0, bytes);
+            collectAll();
+            MPointerTrace::trace(MPointerTraceKind::EmergencyEnd);
+            if (tryCharge(bytes)) {
+                return;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(runtimeMutex);
+        if (policy == LimitPolicy::Block && timeout.count() != 0) {
+            auto start = std::chrono::steady_clock::now();
+            waiters.fetch_add(1);
+            bool charged = released.wait_for(lock, timeout, [this, bytes]() { return tryCharge(bytes); });
+            waiters.fetch_sub(1);
+            blockedMicros.fetch_add(static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+            if (charged) {
+                return;
+            }
+        }
+        failedAllocations.fetch_add(1, std::memory_order_relaxed);
+        throw MPointerHeapLimitExceeded();
+    }
+
+    // Devuelve memoria cobrada y despierta a quien esté esperando
+    void credit(size_t bytes) {
+        liveBytes.fetch_sub(bytes);
+        if (waiters.load() != 0) {
+            std::lock_guard<std::mutex> lock(runtimeMutex);  // Evita perder el aviso entre el predicado y la espera
+            released.notify_all();
+        }
+    }
+
+    size_t getHeapLimit() const {
+        return heapLimit.load(std::memory_order_relaxed);
+    }
+
+    size_t getLiveBytes() const {
+        return liveBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t getPeakBytes() const {
+        return peakBytes.load(std::memory_order_relaxed);
+    }
+
+    size_t getThrottledAllocations() const {
+        return throttledAllocations.load(std::memory_order_relaxed);
+    }
+
+    size_t getFailedAllocations() const {
+        return failedAllocations.load(std::memory_order_relaxed);
+    }
+
+    size_t getEmergencyCollections() const {
+        return emergencyCollections.load(std::memory_order_relaxed);
+    }
+
+    size_t getBlockedMicros() const {
+        return blockedMicros.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // MPOINTERRUNTIME_H
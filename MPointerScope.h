@@ -0,0 +1,199 @@
+#ifndef MPOINTERSCOPE_H
+#define MPOINTERSCOPE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include "MPointerHeap.h"
+#include "MPointerRuntime.h"
+
+// Region (arena) para MPointers temporales.
+// Mientras un MPointerScope esté activo en el hilo, MPointer<T>::New reserva la memoria
+// por bump allocation dentro de la región y no registra el objeto en el GC (sin refCount ni barrido).
+// Al salir del scope se destruyen solo los objetos que lo necesitan y se suelta toda la región de una vez.
+class MPointerScope {
+private:
+    // Bloque de memoria de la región (los datos van justo después del encabezado)
+    struct Chunk {
+        Chunk* next;
+        size_t size;    // Bytes cobrados en el MPointerRuntime
+        bool fromHeap;  // Chunk del MPointerHeap (si no, bloque reservado con malloc)
+    };
+
+    // Registro de un destructor pendiente (solo para T no trivialmente destructible)
+    struct Destructor {
+        void (*destroy)(void*);
+        void* object;
+        Destructor* next;
+    };
+
+    // Los scopes empiezan con bloques chicos de malloc que crecen al doble; recién cuando el bloque
+    // siguiente llegaría al tamaño de un chunk del MPointerHeap se pasa a chunks del heap.
+    // Una reserva de más de LARGE_ALLOCATION bytes va a un bloque propio y no abandona el bloque actual.
+    static constexpr size_t INITIAL_CHUNK_SIZE = 4096;
+    static constexpr size_t LARGE_ALLOCATION = 64 * 1024;
+
+    Chunk* chunks = nullptr;            // Lista de bloques reservados (incluye los de reservas grandes)
+    char* cursor = nullptr;             // Siguiente byte libre del bloque actual
+    char* limit = nullptr;              // Fin del bloque actual
+    size_t nextChunkSize = INITIAL_CHUNK_SIZE;  // Crece al doble para que haya O(log n) bloques
+    size_t bytesUsed = 0;               // Bytes entregados a objetos
+    Destructor* destructors = nullptr;  // Pila de destructores (se ejecutan en orden inverso)
+    MPointerScope* previous;            // Scope exterior (los scopes se pueden anidar)
+#ifndef NDEBUG
+    long liveHandles = 0;               // MPointers vivos que apuntan a la región (solo en debug)
+#endif
+
+    static inline thread_local MPointerScope* current = nullptr;  // Scope activo en este hilo
+
+    template <typename T>
+    static void destroyObject(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+    // Reserva un bloque de `size` bytes (malloc o chunk del heap) y lo agrega a la lista.
+    // El bloque se cobra en el MPointerRuntime: la región cuenta para el límite del heap.
+    Chunk* acquire(size_t size) {
+        MPointerRuntime::getInstance().charge(size);
+        Chunk* chunk;
+        if (size == MPointerHeap::CHUNK_SIZE) {
+            // Las páginas del chunk solo ocupan RSS a medida que la región las toca
+            chunk = static_cast<Chunk*>(MPointerHeap::getInstance().acquireChunk());
+            chunk->fromHeap = true;
+        } else {
+            chunk = static_cast<Chunk*>(std::malloc(size));
+            if (chunk == nullptr) {
+                MPointerRuntime::getInstance().credit(size);
+                throw std::bad_alloc();
+            }
+            chunk->fromHeap = false;
+        }
+        chunk->size = size;
+        chunk->next = chunks;
+        chunks = chunk;
+        return chunk;
+    }
+
+    // Reserva un bloque nuevo con espacio suficiente para al menos `bytes` (bytes <= LARGE_ALLOCATION)
+    void grow(size_t bytes) {
+        size_t size = nextChunkSize;
+        while (size < bytes + sizeof(Chunk) + alignof(std::max_align_t)) {
+            size *= 2;
+        }
+        if (size >= MPointerHeap::CHUNK_SIZE) {
+            size = MPointerHeap::CHUNK_SIZE;
+        } else {
+            nextChunkSize = size * 2;
+        }
+        Chunk* chunk = acquire(size);
+        cursor = reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+        limit = reinterpret_cast<char*>(chunk) + size;
+    }
+
+    // Reserva grande en un bloque propio; cursor y limit no cambian
+    void* allocateLarge(size_t size, size_t alignment) {
+        char* data = reinterpret_cast<char*>(acquire(sizeof(Chunk) + size + alignment)) + sizeof(Chunk);
+        size_t misalignment = reinterpret_cast<uintptr_t>(data) % alignment;
+        bytesUsed += size;
+        return misalignment ? data + alignment - misalignment : data;
+    }
+
+public:
+    MPointerScope() : previous(current) {
+        current = this;
+    }
+
+    MPointerScope(const MPointerScope&) = delete;
+    MPointerScope& operator=(const MPointerScope&) = delete;
+
+    // Scope activo en el hilo actual (nullptr si no hay ninguno)
+    static MPointerScope* active() {
+        return current;
+    }
+
+    // Bump allocation dentro de la región
+    void* allocate(size_t size, size_t alignment) {
+        if (size > LARGE_ALLOCATION) {
+            return allocateLarge(size, alignment);
+        }
+        size_t misalignment = reinterpret_cast<uintptr_t>(cursor) % alignment;
+        size_t padding = misalignment ? alignment - misalignment : 0;
+        if (cursor == nullptr || size + padding > static_cast<size_t>(limit - cursor)) {
+            grow(size + alignment);
+            misalignment = reinterpret_cast<uintptr_t>(cursor) % alignment;
+            padding = misalignment ? alignment - misalignment : 0;
+        }
+        char* result = cursor + padding;
+        cursor = result + size;
+        bytesUsed += size;
+        return result;
+    }
+
+    // Construye un T dentro de la región y anota su destructor solo si hace falta
+    template <typename T>
+    T* create() {
+        T* object = new (allocate(sizeof(T), alignof(T))) T();
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            Destructor* entry = static_cast<Destructor*>(allocate(sizeof(Destructor), alignof(Destructor)));
+            entry->destroy = &destroyObject<T>;
+            entry->object = object;
+            entry->next = destructors;
+            destructors = entry;
+        }
+        return object;
+    }
+
+    size_t getBytesUsed() const {
+        return bytesUsed;
+    }
+
+#ifndef NDEBUG
+    // Contabilidad de MPointers que apuntan a la región (para detectar referencias que escapan)
+    void retainHandle() {
+        ++liveHandles;
+    }
+
+    void releaseHandle() {
+        --liveHandles;
+    }
+
+    long getLiveHandles() const {
+        return liveHandles;
+    }
+#endif
+
+    // Destructor: ejecuta los destructores pendientes y libera toda la región
+    ~MPointerScope() {
+        for (Destructor* entry = destructors; entry != nullptr; entry = entry->next) {
+            entry->destroy(entry->object);
+        }
+
+#ifndef NDEBUG
+        // Cualquier MPointer que siga vivo después de este punto apuntaría a memoria liberada
+        if (liveHandles != 0) {
+            std::cerr << "[MPointerScope] " << liveHandles
+                      << " MPointer(s) escaparon de la región" << std::endl;
+            assert(liveHandles == 0 && "MPointer escapó de su MPointerScope");
+        }
+#endif
+
+        Chunk* chunk = chunks;
+        while (chunk != nullptr) {
+            Chunk* next = chunk->next;
+            MPointerRuntime::getInstance().credit(chunk->size);
+            if (chunk->fromHeap) {
+                MPointerHeap::getInstance().releaseChunk(chunk);
+            } else {
+                std::free(chunk);
+            }
+            chunk = next;
+        }
+        current = previous;
+    }
+};
+
+#endif // MPOINTERSCOPE_H
@@ -0,0 +1,323 @@
+#ifndef MPOINTERSNAPSHOT_H
+#define MPOINTERSNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// Aristas conocidas de un tipo: los MPointers que guarda cada objeto.
+// Por defecto no se conocen; se especializa para que el snapshot (y el análisis de tamaños retenidos)
+// pueda seguir los punteros, p. ej. para Node<T> en DoubleLinkedLIst.h:
+//   template <typename T> struct MPointerSnapshotEdges<Node<T>> {
+//       static constexpr bool known = true;
+//       template <typename Visit> static void forEach(const Node<T>& node, Visit visit) { visit(node.next); visit(node.prev); }
+//   };
+template <typename T>
+struct MPointerSnapshotEdges {
+    static constexpr bool known = false;
+    template <typename Visit>
+    static void forEach(const T&, Visit) {}
+};
+
+// Objeto vivo en el snapshot (24 bytes)
+struct MPointerSnapshotObject {
+    uint64_t address;
+    uint32_t size;
+    int32_t id;        // ID dentro del GC de su tipo
+    int32_t refCount;  // Incluye las referencias sesgadas que aún no se juntaron
+    uint16_t type;     // Índice en la tabla de tipos
+    uint16_t age;      // Recolecciones sobrevividas (modo generacional)
+};
+
+// MPointer guardado dentro de un objeto (16 bytes)
+struct MPointerSnapshotEdge {
+    int32_t fromId;
+    int32_t toId;
+    uint16_t fromType;
+    uint16_t toType;
+    uint32_t reserved;
+};
+
+struct MPointerSnapshotType {
+    std::string name;
+    uint32_t size;
+    bool edgesKnown;
+};
+
+// Snapshot del heap de todos los MPointerGC (MPointerRuntime::writeHeapSnapshot) y lector para el análisis.
+// Archivo binario (orden de bytes de la máquina):
+//   cabecera "MPHS", versión, tipos, objetos, aristas
+//   por tipo: largo del nombre, tamaño, aristas conocidas, nombre
+//   MPointerSnapshotObject[objetos], MPointerSnapshotEdge[aristas]
+class MPointerHeapSnapshot {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    std::vector<MPointerSnapshotType> types;
+    std::vector<MPointerSnapshotObject> objects;
+    std::vector<MPointerSnapshotEdge> edges;
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t typeCount;
+        uint32_t reserved;
+        uint64_t objectCount;
+        uint64_t edgeCount;
+    };
+
+    std::unordered_map<std::type_index, uint16_t> typeIndexes;
+
+    static std::string demangle(const char* name) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && readable != nullptr) {
+            std::string result(readable);
+            std::free(readable);
+            return result;
+        }
+#endif
+        return name;
+    }
+
+public:
+    // Índice del tipo en la tabla (lo agrega la primera vez)
+    template <typename T>
+    uint16_t typeIndex() {
+        auto it = typeIndexes.find(std::type_index(typeid(T)));
+        if (it != typeIndexes.end()) {
+            return it->second;
+        }
+        uint16_t index = static_cast<uint16_t>(types.size());
+        types.push_back({demangle(typeid(T).name()), static_cast<uint32_t>(sizeof(T)),
+                         MPointerSnapshotEdges<T>::known});
+        typeIndexes.emplace(std::type_index(typeid(T)), index);
+        return index;
+    }
+
+    void write(const std::string& path) const {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error("MPointerHeapSnapshot: no se pudo abrir " + path);
+        }
+        Header header = {{'M', 'P', 'H', 'S'}, VERSION, static_cast<uint32_t>(types.size()), 0,
+                         objects.size(), edges.size()};
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        for (const MPointerSnapshotType& type : types) {
+            uint32_t fields[3] = {static_cast<uint32_t>(type.name.size()), type.size, type.edgesKnown ? 1u : 0u};
+            ok = ok && std::fwrite(fields, sizeof(fields), 1, file) == 1;
+            ok = ok && std::fwrite(type.name.data(), 1, type.name.size(), file) == type.name.size();
+        }
+        ok = ok && std::fwrite(objects.data(), sizeof(MPointerSnapshotObject), objects.size(), file) == objects.size();
+        ok = ok && std::fwrite(edges.data(), sizeof(MPointerSnapshotEdge), edges.size(), file) == edges.size();
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok) {
+            throw std::runtime_error("MPointerHeapSnapshot: error al escribir " + path);
+        }
+    }
+
+    static MPointerHeapSnapshot read(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("MPointerHeapSnapshot: no se pudo abrir " + path);
+        }
+        MPointerHeapSnapshot snapshot;
+        Header header;
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, "MPHS", 4) == 0 &&
+                  header.version == VERSION;
+        for (uint32_t i = 0; ok && i < header.typeCount; i++) {
+            uint32_t fields[3];
+            ok = std::fread(fields, sizeof(fields), 1, file) == 1;
+            if (ok) {
+                MPointerSnapshotType type{std::string(fields[0], '\0'), fields[1], fields[2] != 0};
+                ok = std::fread(&type.name[0], 1, fields[0], file) == fields[0];
+                snapshot.types.push_back(std::move(type));
+            }
+        }
+        if (ok) {
+            snapshot.objects.resize(header.objectCount);
+            snapshot.edges.resize(header.edgeCount);
+            ok = std::fread(snapshot.objects.data(), sizeof(MPointerSnapshotObject), snapshot.objects.size(), file) ==
+                     snapshot.objects.size() &&
+                 std::fread(snapshot.edges.data(), sizeof(MPointerSnapshotEdge), snapshot.edges.size(), file) ==
+                     snapshot.edges.size();
+        }
+        // Los índices de tipo se usan sin revisar en retainedSizes y en el analizador
+        size_t typeCount = snapshot.types.size();
+        for (size_t i = 0; ok && i < snapshot.objects.size(); i++) {
+            ok = snapshot.objects[i].type < typeCount;
+        }
+        for (size_t i = 0; ok && i < snapshot.edges.size(); i++) {
+            ok = snapshot.edges[i].fromType < typeCount && snapshot.edges[i].toType < typeCount;
+        }
+        std::fclose(file);
+        if (!ok) {
+            throw std::runtime_error("MPointerHeapSnapshot: archivo inválido " + path);
+        }
+        return snapshot;
+    }
+
+    // Tamaño retenido de cada objeto (mismo orden que `objects`): lo que se liberaría si desapareciera.
+    // Se calcula con el árbol de dominadores desde una raíz virtual que apunta a los objetos con referencias
+    // externas (refCount mayor que sus aristas entrantes, o tipos sin aristas conocidas). Los objetos que
+    // no se alcanzan así solo se sostienen entre ellos (ciclos) y se cuelgan de la raíz; `unreachable`
+    // (opcional) indica cuáles son.
+    std::vector<uint64_t> retainedSizes(std::vector<bool>* unreachable = nullptr) const {
+        size_t count = objects.size();
+        auto key = [](uint16_t type, int32_t id) {
+            return (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(id);
+        };
+        std::unordered_map<uint64_t, size_t> position;  // (tipo, id) -> índice + 1 (0 es la raíz virtual)
+        position.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            position.emplace(key(objects[i].type, objects[i].id), i + 1);
+        }
+
+        // Grafo con la raíz virtual en el nodo 0
+        std::vector<std::vector<size_t>> successors(count + 1);
+        std::vector<std::vector<size_t>> predecessors(count + 1);
+        std::vector<int64_t> incoming(count + 1, 0);
+        for (const MPointerSnapshotEdge& edge : edges) {
+            auto from = position.find(key(edge.fromType, edge.fromId));
+            auto to = position.find(key(edge.toType, edge.toId));
+            if (from != position.end() && to != position.end()) {
+                successors[from->second].push_back(to->second);
+                predecessors[to->second].push_back(from->second);
+                ++incoming[to->second];
+            }
+        }
+        auto addRoot = [&](size_t node) {
+            successors[0].push_back(node);
+            predecessors[node].push_back(0);
+        };
+        for (size_t i = 0; i < count; i++) {
+            const MPointerSnapshotObject& object = objects[i];
+            if (!types[object.type].edgesKnown || object.refCount > incoming[i + 1]) {
+                addRoot(i + 1);
+            }
+        }
+
+        // Orden previo del DFS desde la raíz (iterativo: las listas pueden ser muy largas)
+        std::vector<size_t> preOrder;              // Nodo en cada posición del orden previo
+        std::vector<size_t> number(count + 1, SIZE_MAX);  // Posición de cada nodo (SIZE_MAX = no alcanzado)
+        std::vector<size_t> parent(count + 1, 0);  // Padre en el árbol del DFS (en posiciones)
+        auto depthFirst = [&]() {
+            preOrder.clear();
+            std::fill(number.begin(), number.end(), SIZE_MAX);
+            std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+            number[0] = 0;
+            preOrder.push_back(0);
+            while (!stack.empty()) {
+                auto& top = stack.back();
+                if (top.second < successors[top.first].size()) {
+                    size_t next = successors[top.first][top.second++];
+                    if (number[next] == SIZE_MAX) {
+                        number[next] = preOrder.size();
+                        parent[preOrder.size()] = number[top.first];
+                        preOrder.push_back(next);
+                        stack.push_back({next, 0});
+                    }
+                } else {
+                    stack.pop_back();
+                }
+            }
+        };
+        depthFirst();
+        if (unreachable != nullptr) {
+            unreachable->assign(count, false);
+        }
+        if (preOrder.size() < count + 1) {
+            // Ciclos sin referencias externas: se cuelgan de la raíz y se vuelve a recorrer
+            for (size_t node = 1; node <= count; node++) {
+                if (number[node] == SIZE_MAX) {
+                    if (unreachable != nullptr) {
+                        (*unreachable)[node - 1] = true;
+                    }
+                    addRoot(node);
+                }
+            }
+            depthFirst();
+        }
+
+        // Dominadores inmediatos con Lengauer-Tarjan (versión simple con compresión de caminos), todo en
+        // posiciones del orden previo
+        size_t reached = preOrder.size();
+        std::vector<size_t> semi(reached), label(reached), dominator(reached, 0);
+        std::vector<size_t> ancestor(reached, SIZE_MAX);
+        std::vector<std::vector<size_t>> bucket(reached);
+        for (size_t i = 0; i < reached; i++) {
+            semi[i] = i;
+            label[i] = i;
+        }
+        std::vector<size_t> path;
+        auto eval = [&](size_t v) {
+            if (ancestor[v] == SIZE_MAX) {
+                return v;
+            }
+            path.clear();
+            for (size_t x = v; ancestor[ancestor[x]] != SIZE_MAX; x = ancestor[x]) {
+                path.push_back(x);
+            }
+            for (size_t i = path.size(); i-- > 0;) {
+                size_t x = path[i];
+                size_t a = ancestor[x];
+                if (semi[label[a]] < semi[label[x]]) {
+                    label[x] = label[a];
+                }
+                ancestor[x] = ancestor[a];
+            }
+            return label[v];
+        };
+        for (size_t w = reached - 1; w > 0; w--) {
+            for (size_t predecessor : predecessors[preOrder[w]]) {
+                size_t v = number[predecessor];
+                if (v != SIZE_MAX) {
+                    size_t u = eval(v);
+                    if (semi[u] < semi[w]) {
+                        semi[w] = semi[u];
+                    }
+                }
+            }
+            bucket[semi[w]].push_back(w);
+            ancestor[w] = parent[w];
+            for (size_t v : bucket[parent[w]]) {
+                size_t u = eval(v);
+                dominator[v] = semi[u] < semi[v] ? u : parent[w];
+            }
+            bucket[parent[w]].clear();
+        }
+        for (size_t w = 1; w < reached; w++) {
+            if (dominator[w] != semi[w]) {
+                dominator[w] = dominator[dominator[w]];
+            }
+        }
+
+        // Cada nodo suma su tamaño retenido al de su dominador (que siempre va antes en el orden previo)
+        std::vector<uint64_t> retained(reached, 0);
+        for (size_t w = reached - 1; w > 0; w--) {
+            retained[w] += objects[preOrder[w] - 1].size;
+            retained[dominator[w]] += retained[w];
+        }
+        std::vector<uint64_t> result(count);
+        for (size_t node = 1; node <= count; node++) {
+            result[node - 1] = retained[number[node]];
+        }
+        return result;
+    }
+};
+
+#endif // MPOINTERSNAPSHOT_H
@@ -0,0 +1,245 @@
+#ifndef MPOINTERTRACE_H
+#define MPOINTERTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Qué pasó (cabe en 16 bits para que el evento quede en 24 bytes)
+enum class MPointerTraceKind : uint16_t {
+    New = 1,           // MPointer::New reservó un objeto (arg = sizeof(T))
+    Register = 2,      // El objeto entró al registro del GC (id)
+    RefCountZero = 3,  // Un refCount llegó a 0 (id)
+    SweepStart = 4,    // Empieza un ciclo de recolección (arg = ciclos anteriores)
+    SweepEnd = 5,      // Termina el ciclo (arg = objetos liberados)
+    Free = 6,          // Objeto sacado del registro para destruirse (id)
+    SliceStart = 7,    // Rebanada del barrido con gcMutex tomado
+    SliceEnd = 8,      // (arg = objetos revisados)
+    EmergencyStart = 9,  // Recolección de emergencia por el límite del heap (arg = bytes pedidos)
+    EmergencyEnd = 10
+};
+
+// Evento binario compacto
+struct MPointerTraceEvent {
+    uint64_t timestamp;  // Contador de ciclos de la CPU (TSC) o, si no hay, nanosegundos de steady_clock
+    uint64_t arg;
+    int32_t id;
+    MPointerTraceKind kind;
+    uint16_t thread;     // Número de hilo asignado por el tracer (no el TID del sistema)
+};
+
+// Tracer de eventos del GC y de MPointer.
+// Cada hilo escribe en su propio ring buffer (un productor, un consumidor, sin locks); si el buffer está
+// lleno el evento se descarta y se cuenta. Desactivado cuesta una carga relaxed por punto de trazado.
+// drain() y MPointerTraceDumper vacían los buffers de todos los hilos.
+class MPointerTrace {
+public:
+    static constexpr size_t RING_SIZE = size_t(1) << 14;  // Eventos por hilo (potencia de 2)
+
+private:
+    struct Ring {
+        MPointerTraceEvent events[RING_SIZE];
+        std::atomic<uint64_t> head{0};  // Siguiente posición a escribir (solo el hilo dueño)
+        std::atomic<uint64_t> tail{0};  // Siguiente posición a leer (solo quien drena, con drainMutex)
+        std::atomic<bool> retired{false};  // El hilo terminó: se borra cuando quede vacío
+        uint16_t thread = 0;
+    };
+
+    // Registra el ring del hilo la primera vez y lo marca como retirado cuando el hilo termina
+    struct RingHolder {
+        std::shared_ptr<Ring> ring;
+        ~RingHolder() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    static inline std::atomic<bool> active{false};
+    static inline std::atomic<uint64_t> dropped{0};
+    static inline std::atomic<uint16_t> nextThread{1};
+    static inline std::mutex ringsMutex;  // Protege rings (solo al crear un ring y al drenar)
+    static inline std::vector<std::shared_ptr<Ring>> rings;
+    static inline std::mutex drainMutex;  // Un solo consumidor a la vez
+    static inline thread_local Ring* localRing = nullptr;
+    static inline thread_local RingHolder localHolder;
+
+    static Ring* ringForThread() {
+        if (localRing == nullptr) {
+            auto ring = std::make_shared<Ring>();
+            ring->thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(ringsMutex);
+                rings.push_back(ring);
+            }
+            localHolder.ring = ring;
+            localRing = ring.get();
+        }
+        return localRing;
+    }
+
+    static void record(MPointerTraceKind kind, int32_t id, uint64_t arg) {
+        Ring* ring = ringForThread();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->tail.load(std::memory_order_acquire) >= RING_SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        MPointerTraceEvent& event = ring->events[head & (RING_SIZE - 1)];
+        event.timestamp = now();
+        event.arg = arg;
+        event.id = id;
+        event.kind = kind;
+        event.thread = ring->thread;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+public:
+    // Activa o desactiva el trazado en tiempo de ejecución
+    static void setEnabled(bool enabled) {
+        active.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool enabled() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // Punto de trazado: no hace nada (ni toca el thread_local) si el tracer está apagado
+    static void trace(MPointerTraceKind kind, int32_t id = 0, uint64_t arg = 0) {
+        if (enabled()) {
+            record(kind, id, arg);
+        }
+    }
+
+    // Marca de tiempo de los eventos
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Marcas de now() por microsegundo; se mide una sola vez por proceso (~1 ms de espera activa)
+    static double ticksPerMicro() {
+        static const double rate = []() {
+#if defined(__x86_64__) || defined(__i386__)
+            auto wallStart = std::chrono::steady_clock::now();
+            uint64_t ticksStart = now();
+            std::chrono::steady_clock::time_point wall;
+            do {
+                wall = std::chrono::steady_clock::now();
+            } while (wall - wallStart < std::chrono::milliseconds(1));
+            double micros = std::chrono::duration<double, std::micro>(wall - wallStart).count();
+            return static_cast<double>(now() - ticksStart) / micros;
+#else
+            return 1000.0;  // now() ya está en nanosegundos
+#endif
+        }();
+        return rate;
+    }
+
+    // Eventos descartados porque el ring de su hilo estaba lleno
+    static uint64_t getDropped() {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Saca los eventos de todos los hilos (en orden dentro de cada hilo) y los agrega a `out`
+    static size_t drain(std::vector<MPointerTraceEvent>& out) {
+        std::lock_guard<std::mutex> drainLock(drainMutex);
+        std::vector<std::shared_ptr<Ring>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            snapshot = rings;
+        }
+        size_t count = 0;
+        for (auto& ring : snapshot) {
+            bool retired = ring->retired.load(std::memory_order_acquire);
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail, ++count) {
+                out.push_back(ring->events[tail & (RING_SIZE - 1)]);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+            if (retired) {
+                std::lock_guard<std::mutex> lock(ringsMutex);
+                for (auto it = rings.begin(); it != rings.end(); ++it) {
+                    if (*it == ring) {
+                        rings.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    // Drena todo y agrega los eventos en binario (MPointerTraceEvent tal cual) al final de `path`
+    static size_t drainToFile(const std::string& path) {
+        std::vector<MPointerTraceEvent> events;
+        drain(events);
+        if (events.empty()) {
+            return 0;
+        }
+        std::FILE* file = std::fopen(path.c_str(), "ab");
+        if (file == nullptr) {
+            return 0;
+        }
+        size_t written = std::fwrite(events.data(), sizeof(MPointerTraceEvent), events.size(), file);
+        std::fclose(file);
+        return written;
+    }
+};
+
+// Hilo que drena el tracer a un archivo cada `interval` (y una última vez al detenerse)
+class MPointerTraceDumper {
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex dumperMutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+    std::thread thread;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(dumperMutex);
+        while (!stopping) {
+            wakeup.wait_for(lock, interval, [this]() { return stopping; });
+            lock.unlock();
+            MPointerTrace::drainToFile(path);
+            lock.lock();
+        }
+    }
+
+public:
+    MPointerTraceDumper(std::string file, std::chrono::milliseconds period = std::chrono::milliseconds(100))
+        : path(std::move(file)), interval(period) {
+        thread = std::thread(&MPointerTraceDumper::run, this);
+    }
+
+    MPointerTraceDumper(const MPointerTraceDumper&) = delete;
+    MPointerTraceDumper& operator=(const MPointerTraceDumper&) = delete;
+
+    ~MPointerTraceDumper() {
+        {
+            std::lock_guard<std::mutex> lock(dumperMutex);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        thread.join();
+    }
+};
+
+#endif // MPOINTERTRACE_H
@@ -0,0 +1,110 @@
+#ifndef MPOINTERWORKERS_H
+#define MPOINTERWORKERS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fijo de hilos para repartir el trabajo del GC (barrido y destrucción de objetos).
+// parallelFor bloquea hasta que todas las tareas terminan; el hilo que llama también trabaja.
+class MPointerWorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex poolMutex;
+    std::condition_variable wakeup;     // Avisa a los hilos que hay una tanda nueva de tareas
+    std::condition_variable finishedCv; // Avisa al que llamó que terminó la tanda
+    const std::function<void(size_t)>* task = nullptr;
+    size_t taskCount = 0;
+    size_t nextTask = 0;
+    size_t finished = 0;
+    unsigned generation = 0;  // Número de tanda, para que cada hilo sepa si hay trabajo nuevo
+    bool stopping = false;
+
+    // Toma tareas de la tanda actual hasta que no quede ninguna
+    void runTasks() {
+        while (true) {
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                if (nextTask >= taskCount) {
+                    return;
+                }
+                index = nextTask++;
+            }
+            (*task)(index);
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                if (++finished == taskCount) {
+                    finishedCv.notify_all();
+                }
+            }
+        }
+    }
+
+    void workerLoop() {
+        unsigned seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(poolMutex);
+                wakeup.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            runTasks();
+        }
+    }
+
+public:
+    // `workers` hilos en total contando al que llama a parallelFor
+    explicit MPointerWorkerPool(size_t workers) {
+        for (size_t i = 1; i < workers; i++) {
+            threads.emplace_back(&MPointerWorkerPool::workerLoop, this);
+        }
+    }
+
+    MPointerWorkerPool(const MPointerWorkerPool&) = delete;
+    MPointerWorkerPool& operator=(const MPointerWorkerPool&) = delete;
+
+    size_t size() const {
+        return threads.size() + 1;
+    }
+
+    // Ejecuta body(0) ... body(count - 1) repartido entre los hilos
+    void parallelFor(size_t count, const std::function<void(size_t)>& body) {
+        if (count == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            task = &body;
+            taskCount = count;
+            nextTask = 0;
+            finished = 0;
+            ++generation;
+        }
+        wakeup.notify_all();
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(poolMutex);
+        finishedCv.wait(lock, [this]() { return finished == taskCount; });
+        task = nullptr;
+    }
+
+    ~MPointerWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+#endif // MPOINTERWORKERS_H
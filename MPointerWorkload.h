@@ -0,0 +1,259 @@
+#ifndef MPOINTERWORKLOAD_H
+#define MPOINTERWORKLOAD_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include "MPointer.h"
+
+// Piezas comunes del generador de carga (main.cpp) y del reproductor de grabaciones (mpointer_replay.cpp):
+// objetos de tamaño configurable, opciones de MPointerGC por línea de comandos y el reporte de pausas.
+
+// Tamaños de objeto disponibles: un tamaño pedido se redondea hacia arriba a una de estas clases
+constexpr size_t MPOINTER_SIZE_CLASSES[] = {16, 32, 64, 128, 256, 512, 1024, 4096};
+constexpr size_t MPOINTER_SIZE_CLASS_COUNT = sizeof(MPOINTER_SIZE_CLASSES) / sizeof(MPOINTER_SIZE_CLASSES[0]);
+
+template <size_t Size>
+struct MPointerPayload {
+    unsigned char bytes[Size];
+};
+
+template <size_t Index>
+using MPointerClassPayload = MPointerPayload<MPOINTER_SIZE_CLASSES[Index]>;
+
+inline size_t mpointerSizeClass(uint64_t bytes) {
+    for (size_t i = 0; i < MPOINTER_SIZE_CLASS_COUNT; i++) {
+        if (bytes <= MPOINTER_SIZE_CLASSES[i]) {
+            return i;
+        }
+    }
+    return MPOINTER_SIZE_CLASS_COUNT - 1;
+}
+
+template <typename Visit, size_t... I>
+void withSizeClass(size_t index, Visit&& visit, std::index_sequence<I...>) {
+    ((index == I ? visit(std::integral_constant<size_t, I>{}) : void()), ...);
+}
+
+// Llama a visit(std::integral_constant<size_t, I>) con la clase de tamaño `index`
+template <typename Visit>
+void withSizeClass(size_t index, Visit&& visit) {
+    withSizeClass(index, visit, std::make_index_sequence<MPOINTER_SIZE_CLASS_COUNT>{});
+}
+
+template <typename Visit>
+void forEachSizeClass(Visit&& visit) {
+    for (size_t index = 0; index < MPOINTER_SIZE_CLASS_COUNT; index++) {
+        withSizeClass(index, visit);
+    }
+}
+
+// Configuración de MPointerGC elegida por línea de comandos (--clave=valor)
+struct MPointerCollectorOptions {
+    CollectionMode mode = CollectionMode::Background;
+    RefCountMode refCount = RefCountMode::Locked;
+    size_t sweepWorkers = 1;
+    bool generational = false;
+    size_t collectEvery = 0;      // Con mode=manual: collect() cada N operaciones (o eventos)
+    size_t intervalMillis = 1000;  // CollectionTriggers::maxLatency
+    size_t triggerBytes = 0;      // CollectionTriggers::bytesAllocated
+    size_t sliceMicros = 0;       // Presupuesto de cada rebanada del barrido incremental (0 = sin rebanadas)
+    size_t recycleCapacity = 0;   // Pool de reciclaje (0 = desactivado, como por defecto)
+    size_t heapLimitMiB = 0;      // MPointerRuntime::setHeapLimit (0 = sin límite)
+
+    static constexpr const char* USAGE =
+        "  --mode=MODO          background | manual | immediate (background)\n"
+        "  --refcount=MODO      locked | deferred | atomic | biased (locked)\n"
+        "  --sweep-workers=N    hilos del barrido paralelo (1)\n"
+        "  --generational       recoleccion generacional\n"
+        "  --collect-every=N    con --mode=manual, collect() cada N operaciones (0)\n"
+        "  --interval=MS        tiempo maximo entre ciclos del hilo del GC (1000)\n"
+        "  --trigger-bytes=N    recolectar cada N bytes reservados (0 = desactivado)\n"
+        "  --slice-us=N         barrido incremental con rebanadas de N us (0 = desactivado)\n"
+        "  --recycle=N          capacidad del pool de reciclaje (0 = desactivado)\n"
+        "  --heap-limit=MIB     limite del heap con recoleccion de emergencia (0 = sin limite)\n";
+
+    // Interpreta una opción del GC; devuelve false si la clave no es del GC
+    bool parse(const std::string& key, const std::string& value) {
+        if (key == "mode") {
+            if (value == "background") {
+                mode = CollectionMode::Background;
+            } else if (value == "manual") {
+                mode = CollectionMode::Manual;
+            } else if (value == "immediate") {
+                mode = CollectionMode::Immediate;
+            } else {
+                throw std::invalid_argument("modo desconocido: " + value);
+            }
+        } else if (key == "refcount") {
+            if (value == "locked") {
+                refCount = RefCountMode::Locked;
+            } else if (value == "deferred") {
+                refCount = RefCountMode::Deferred;
+            } else if (value == "atomic") {
+                refCount = RefCountMode::Atomic;
+            } else if (value == "biased") {
+                refCount = RefCountMode::Biased;
+            } else {
+                throw std::invalid_argument("conteo desconocido: " + value);
+            }
+        } else if (key == "generational") {
+            generational = value.empty() || value == "1" || value == "true";
+        } else if (key == "sweep-workers") {
+            sweepWorkers = std::max<size_t>(1, std::stoul(value));
+        } else if (key == "collect-every") {
+            collectEvery = std::stoul(value);
+        } else if (key == "interval") {
+            intervalMillis = std::stoul(value);
+        } else if (key == "trigger-bytes") {
+            triggerBytes = std::stoul(value);
+        } else if (key == "slice-us") {
+            sliceMicros = std::stoul(value);
+        } else if (key == "recycle") {
+            recycleCapacity = std::stoul(value);
+        } else if (key == "heap-limit") {
+            heapLimitMiB = std::stoul(value);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void validate() const {
+        if (mode == CollectionMode::Immediate && refCount == RefCountMode::Deferred) {
+            throw std::invalid_argument("--mode=immediate no sirve con --refcount=deferred");
+        }
+    }
+
+    std::string describe() const {
+        static const char* modeNames[] = {"background", "manual", "immediate"};
+        static const char* refCountNames[] = {"locked", "deferred", "atomic", "biased"};
+        return std::string("mode=") + modeNames[static_cast<int>(mode)] +
+               " refcount=" + refCountNames[static_cast<int>(refCount)] +
+               " sweep-workers=" + std::to_string(sweepWorkers) + " generational=" + std::to_string(generational) +
+               " collect-every=" + std::to_string(collectEvery) + " interval=" + std::to_string(intervalMillis) +
+               " trigger-bytes=" + std::to_string(triggerBytes) + " slice-us=" + std::to_string(sliceMicros) +
+               " recycle=" + std::to_string(recycleCapacity) + " heap-limit=" + std::to_string(heapLimitMiB);
+    }
+
+    template <typename T>
+    void apply(MPointerGC<T>* gc) const {
+        gc->setRefCountMode(refCount);
+        gc->setGenerational(generational);
+        gc->setSweepWorkers(sweepWorkers);
+        CollectionTriggers triggers;
+        triggers.maxLatency = std::chrono::milliseconds(intervalMillis);
+        triggers.bytesAllocated = triggerBytes;
+        gc->setCollectionTriggers(triggers);
+        gc->setIncrementalBudget(std::chrono::microseconds(sliceMicros), 0);
+        gc->setRecycleCapacity(recycleCapacity);
+        gc->setCollectionMode(mode);
+    }
+
+    // Aplica la configuración a los GC de todas las clases de tamaño y de los tipos `Extra`
+    template <typename... Extra>
+    void applyAll() const {
+        if (heapLimitMiB != 0) {
+            MPointerRuntime::getInstance().setHeapLimit(heapLimitMiB << 20);
+        }
+        forEachSizeClass([this](auto index) {
+            apply(MPointerGC<MPointerClassPayload<decltype(index)::value>>::getInstance());
+        });
+        (apply(MPointerGC<Extra>::getInstance()), ...);
+    }
+};
+
+// collect() en los GC de todas las clases de tamaño
+inline void collectSizeClasses() {
+    forEachSizeClass([](auto index) {
+        MPointerGC<MPointerClassPayload<decltype(index)::value>>::getInstance()->collect();
+    });
+}
+
+// Suma las estadísticas de los GC de todas las clases de tamaño y de los tipos `Extra`
+template <typename... Extra>
+MPointerGCStats mpointerCollectorStats() {
+    MPointerGCStats total;
+    auto add = [&total](const MPointerGCStats& stats) {
+        total.allocations += stats.allocations;
+        total.frees += stats.frees;
+        total.liveObjects += stats.liveObjects;
+        total.liveBytes += stats.liveBytes;
+        total.collections += stats.collections;
+        total.totalPauseMicros += stats.totalPauseMicros;
+        total.maxPauseMicros = std::max(total.maxPauseMicros, stats.maxPauseMicros);
+        total.pauseHistogram.resize(std::max(total.pauseHistogram.size(), stats.pauseHistogram.size()));
+        for (size_t k = 0; k < stats.pauseHistogram.size(); k++) {
+            total.pauseHistogram[k] += stats.pauseHistogram[k];
+        }
+    };
+    forEachSizeClass([&add](auto index) {
+        add(MPointerGC<MPointerClassPayload<decltype(index)::value>>::getInstance()->stats());
+    });
+    (add(MPointerGC<Extra>::getInstance()->stats()), ...);
+    return total;
+}
+
+// Contadores entre dos lecturas de mpointerCollectorStats() (maxPauseMicros queda el de `after`)
+inline MPointerGCStats mpointerStatsSince(const MPointerGCStats& before, const MPointerGCStats& after) {
+    MPointerGCStats delta = after;
+    delta.collections -= before.collections;
+    delta.totalPauseMicros -= before.totalPauseMicros;
+    delta.allocations -= before.allocations;
+    delta.frees -= before.frees;
+    for (size_t k = 0; k < before.pauseHistogram.size() && k < delta.pauseHistogram.size(); k++) {
+        delta.pauseHistogram[k] -= before.pauseHistogram[k];
+    }
+    return delta;
+}
+
+// Menor 2^k (en microsegundos) que acota la fracción pedida de las pausas
+inline size_t mpointerPausePercentile(const std::vector<size_t>& histogram, double fraction) {
+    size_t total = 0;
+    for (size_t count : histogram) {
+        total += count;
+    }
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(total ? total - 1 : 0)) + 1;
+    size_t seen = 0;
+    for (size_t k = 0; k < histogram.size(); k++) {
+        seen += histogram[k];
+        if (seen >= rank) {
+            return size_t(1) << k;
+        }
+    }
+    return 0;
+}
+
+// Resumen y distribución de las pausas del GC
+inline void printPauses(std::ostream& out, const MPointerGCStats& pauses) {
+    out << "Pausas del GC: " << pauses.collections << " ciclos, total " << pauses.totalPauseMicros
+        << " us, max " << pauses.maxPauseMicros << " us";
+    if (pauses.collections != 0) {
+        out << ", p50 < " << mpointerPausePercentile(pauses.pauseHistogram, 0.5)
+            << " us, p99 < " << mpointerPausePercentile(pauses.pauseHistogram, 0.99) << " us, p999 < "
+            << mpointerPausePercentile(pauses.pauseHistogram, 0.999) << " us";
+    }
+    out << std::endl;
+    for (size_t k = 0; k < pauses.pauseHistogram.size(); k++) {
+        if (pauses.pauseHistogram[k] != 0) {
+            out << std::setw(14) << ("< " + std::to_string(size_t(1) << k) + " us") << std::setw(12)
+                << pauses.pauseHistogram[k] << std::endl;
+        }
+    }
+}
+
+inline size_t peakResidentKilobytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);  // Linux: KiB
+}
+
+#endif // MPOINTERWORKLOAD_H
@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MPointer.h"
+#include "MPointerTrace.h"
+#include "MPointerChromeTrace.h"
+#include "MPointerProfiler.h"
+#include "DoubleLinkedLIst.h"
+
+// Benchmarks de MPointer / MPointerGC.
+// Uso: ./benchmark_mpointer [nombre...]   (sin argumentos corre todos)
+
+// Mide el tiempo promedio de `repetitions` ejecuciones en microsegundos
+static double measureMicros(int repetitions, const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i++) {
+        work();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / repetitions;
+}
+
+// Construye una lista cuyos nodos quedan dispersos en el heap: entre cada nodo de la lista
+// se crean nodos de relleno que luego se liberan, dejando huecos en el slab
+static void buildFragmentedList(DoublyLinkedList<int>& list, int size, int fillersPerNode) {
+    MPointerGC<Node<int>>* gc = MPointerGC<Node<int>>::getInstance();
+    std::vector<MPointer<Node<int>>> fillers;
+    for (int i = 0; i < size; i++) {
+        list.append(size - i);
+        for (int j = 0; j < fillersPerNode; j++) {
+            fillers.push_back(MPointer<Node<int>>::New());
+        }
+    }
+    std::vector<int> ids;
+    for (auto& filler : fillers) {
+        ids.push_back(filler.getId());
+        filler = nullptr;
+    }
+    for (int id : ids) {
+        gc->FreeMemory(id);
+    }
+}
+
+// Recorrido de una DoublyLinkedList fragmentada antes y después de compactar el heap de nodos
+static void benchmarkCompaction() {
+    const int size = 20000;
+    MPointerGC<Node<int>>* gc = MPointerGC<Node<int>>::getInstance();
+    DoublyLinkedList<int> list;
+    buildFragmentedList(list, size, 7);
+
+    double fragmentedFragmentation = gc->getFragmentation();
+    double fragmentedTraversal = measureMicros(20, [&list]() { list.size(); });
+
+    auto start = std::chrono::steady_clock::now();
+    size_t moved = gc->compact();
+    double compactionMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    list.size();  // Primer recorrido: los MPointers resuelven su nueva dirección por ID
+    double compactedTraversal = measureMicros(20, [&list]() { list.size(); });
+
+    std::cout << "[compaction] nodos=" << size
+              << " fragmentacion antes=" << fragmentedFragmentation
+              << " despues=" << gc->getFragmentation() << std::endl;
+    std::cout << "[compaction] compact(): " << moved << " objetos movidos en " << compactionMicros << " us" << std::endl;
+    std::cout << "[compaction] recorrido antes=" << fragmentedTraversal
+              << " us, despues=" << compactedTraversal << " us" << std::endl;
+}
+
+// Construye una lista cuyos nodos quedan en orden aleatorio en el heap: los nodos nuevos ocupan
+// los huecos que dejaron nodos de relleno liberados en orden aleatorio
+static void buildScatteredList(DoublyLinkedList<int>& list, int size, unsigned seed) {
+    MPointerGC<Node<int>>* gc = MPointerGC<Node<int>>::getInstance();
+    std::vector<MPointer<Node<int>>> fillers = MPointer<Node<int>>::NewBlock(size * 2);
+    std::vector<int> ids;
+    for (auto& filler : fillers) {
+        ids.push_back(filler.getId());
+        filler = nullptr;
+    }
+    std::srand(seed);
+    for (size_t i = ids.size() - 1; i > 0; i--) {
+        std::swap(ids[i], ids[std::rand() % (i + 1)]);
+    }
+    for (int id : ids) {
+        gc->FreeMemory(id);
+    }
+    for (int i = 0; i < size; i++) {
+        list.append(std::rand() % 1000);
+    }
+}
+
+// Recorrido y ordenamiento de una lista dispersa antes y después de relayout()
+static void benchmarkRelayout() {
+    {
+        const int size = 20000;
+        DoublyLinkedList<int> list;
+        buildScatteredList(list, size, 1);
+        double scatteredTraversal = measureMicros(20, [&list]() { list.size(); });
+        list.relayout();
+        double contiguousTraversal = measureMicros(20, [&list]() { list.size(); });
+        std::cout << "[relayout] nodos=" << size << " recorrido antes=" << scatteredTraversal
+                  << " us, despues=" << contiguousTraversal << " us" << std::endl;
+    }
+    {
+        const int size = 400;
+        DoublyLinkedList<int> scattered;
+        DoublyLinkedList<int> contiguous;
+        buildScatteredList(scattered, size, 2);
+        buildScatteredList(contiguous, size, 2);
+        contiguous.relayout();
+        double scatteredSort = measureMicros(1, [&scattered]() { quickSort(scattered); });
+        double contiguousSort = measureMicros(1, [&contiguous]() { quickSort(contiguous); });
+        std::cout << "[relayout] quickSort nodos=" << size << " antes=" << scatteredSort
+                  << " us, despues=" << contiguousSort << " us" << std::endl;
+    }
+}
+
+// Histograma de pausas del barrido incremental con un presupuesto de 100 us por rebanada
+static void benchmarkIncremental() {
+    const int size = 50000;
+    MPointerGC<int>* gc = MPointerGC<int>::getInstance();
+    gc->setIncrementalBudget(std::chrono::microseconds(100), 0);
+    {
+        std::vector<MPointer<int>> garbage;
+        for (int i = 0; i < size; i++) {
+            garbage.push_back(MPointer<int>::New());
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));  // Un ciclo del GC
+
+    std::cout << "[incremental] objetos=" << size << " pausa maxima=" << gc->getMaxPauseMicros() << " us" << std::endl;
+    std::vector<size_t> histogram = gc->getPauseHistogram();
+    for (size_t bucket = 0; bucket < histogram.size(); bucket++) {
+        if (histogram[bucket] != 0) {
+            std::cout << "[incremental]   < " << (size_t(1) << bucket) << " us: " << histogram[bucket] << std::endl;
+        }
+    }
+    gc->setIncrementalBudget(std::chrono::microseconds(0), 0);
+}
+
+// Objeto con destructor no trivial (libera memoria propia) para el barrido en paralelo
+struct SweepPayload {
+    std::vector<int> data = std::vector<int>(32);
+};
+
+// Throughput del barrido según la cantidad de workers
+static void benchmarkParallelSweep() {
+    const int size = 200000;
+    MPointerGC<SweepPayload>* gc = MPointerGC<SweepPayload>::getInstance();
+    for (size_t workers : {1, 2, 4, 8}) {
+        gc->setSweepWorkers(workers);
+        size_t collectionsBefore = gc->getCollectionCount();
+        {
+            std::vector<MPointer<SweepPayload>> garbage = MPointer<SweepPayload>::NewBlock(size);
+        }
+        // Esperar el ciclo del GC que libera el lote completo
+        while (gc->getCollectionCount() == collectionsBefore ||
+               gc->getLastCollectionFreed() != static_cast<size_t>(size)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        size_t micros = gc->getLastCollectionMicros();
+        std::cout << "[parallel-sweep] workers=" << workers << " objetos=" << size
+                  << " ciclo=" << micros << " us ("
+                  << (micros ? size * 1000000.0 / micros : 0.0) << " objetos/s)" << std::endl;
+    }
+    gc->setSweepWorkers(1);
+}
+
+// Varios hilos copian y destruyen el mismo MPointer (p. ej. la cabeza de una lista compartida)
+static double runSharedCopies(MPointer<int>& shared, int threads, int copiesPerThread) {
+    return measureMicros(1, [&]() {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&shared, copiesPerThread]() {
+                for (int i = 0; i < copiesPerThread; i++) {
+                    MPointer<int> copy = shared;
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+// Conteo con gcMutex contra conteo diferido con logs por hilo
+static void benchmarkDeferredRefCounting() {
+    const int threads = 4;
+    const int copies = 200000;
+    MPointerGC<int>* gc = MPointerGC<int>::getInstance();
+    MPointer<int> shared = MPointer<int>::New();
+
+    double locked = runSharedCopies(shared, threads, copies);
+    gc->setDeferredRefCounting(true);
+    double deferred = runSharedCopies(shared, threads, copies);
+    gc->setDeferredRefCounting(false);
+
+    std::cout << "[deferred-rc] hilos=" << threads << " copias/hilo=" << copies
+              << " con lock=" << locked << " us, diferido=" << deferred << " us" << std::endl;
+}
+
+// Tipos distintos para que cada modo de conteo tenga su propio GC
+template <int N>
+struct RcPayload {
+    int value = 0;
+};
+
+// Copias en el hilo que creó el objeto y copias compartidas entre hilos según el modo de conteo.
+// Medir con Release: sin inline (Debug) las cargas y stores de std::atomic son llamadas y el camino sesgado
+// del dueño queda más lento que un fetch_add
+template <int N>
+static void runRefCountMode(const char* name, RefCountMode mode) {
+    const int threads = 4;
+    const int copies = 200000;
+    MPointerGC<RcPayload<N>>::getInstance()->setRefCountMode(mode);
+    MPointer<RcPayload<N>> shared = MPointer<RcPayload<N>>::New();
+
+    double owner = measureMicros(1, [&shared]() {
+        for (int i = 0; i < threads * copies; i++) {
+            MPointer<RcPayload<N>> copy = shared;
+        }
+    });
+    double foreign = measureMicros(1, [&shared]() {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&shared]() {
+                for (int i = 0; i < copies; i++) {
+                    MPointer<RcPayload<N>> copy = shared;
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+    std::cout << "[biased-rc] " << name << ": hilo dueno=" << owner << " us, " << threads
+              << " hilos ajenos=" << foreign << " us (" << threads * copies << " copias)" << std::endl;
+}
+
+// Conteo con lock, atómico y sesgado
+static void benchmarkBiasedRefCounting() {
+    runRefCountMode<0>("lock", RefCountMode::Locked);
+    runRefCountMode<1>("atomico", RefCountMode::Atomic);
+    runRefCountMode<2>("sesgado", RefCountMode::Biased);
+}
+
+template <int N>
+struct BurstPayload {
+    char data[64] = {};
+};
+
+// Ráfaga de basura: memoria máxima ocupada con el temporizador de 1 s y con disparo por volumen
+template <int N>
+static void runAllocationBurst(const char* name, const CollectionTriggers& triggers) {
+    const int size = 2000000;
+    MPointerGC<BurstPayload<N>>* gc = MPointerGC<BurstPayload<N>>::getInstance();
+    gc->setCollectionTriggers(triggers);
+    size_t peakChunks = 0;
+    double micros = measureMicros(1, [&]() {
+        for (int i = 0; i < size; i++) {
+            MPointer<BurstPayload<N>>::New();
+            if (i % 10000 == 0) {
+                peakChunks = std::max(peakChunks, gc->getSlabChunks());
+            }
+        }
+    });
+    std::cout << "[triggers] " << name << ": " << size << " objetos en " << micros << " us, pico="
+              << peakChunks * MPointerHeap::CHUNK_SIZE / 1024 << " KiB, ciclos=" << gc->getCollectionCount()
+              << ", intervalo final=" << gc->getCollectionInterval().count() << " ms" << std::endl;
+}
+
+static void benchmarkTriggers() {
+    runAllocationBurst<10>("temporizador 1 s", CollectionTriggers());
+    CollectionTriggers volume;
+    volume.bytesAllocated = 4 * 1024 * 1024;
+    volume.adaptive = true;
+    runAllocationBurst<11>("umbral 4 MiB adaptativo", volume);
+}
+
+// Churn: lotes de objetos que viven poco. Mide el throughput y el pico de memoria (slab del tipo y RSS)
+template <int N>
+static void runReclamation(const char* name, CollectionMode mode) {
+    const int batches = 2000;
+    const int batchSize = 1000;
+    MPointerGC<BurstPayload<N>>* gc = MPointerGC<BurstPayload<N>>::getInstance();
+    gc->setCollectionMode(mode);
+    size_t rssBefore = MPointerHeap::getProcessResidentBytes();
+    size_t peakChunks = 0;
+    size_t peakRss = rssBefore;
+    double micros = measureMicros(1, [&]() {
+        for (int batch = 0; batch < batches; batch++) {
+            std::vector<MPointer<BurstPayload<N>>> live;
+            live.reserve(batchSize);
+            for (int i = 0; i < batchSize; i++) {
+                live.push_back(MPointer<BurstPayload<N>>::New());
+            }
+            if (batch % 20 == 0) {
+                peakChunks = std::max(peakChunks, gc->getSlabChunks());
+                peakRss = std::max(peakRss, MPointerHeap::getProcessResidentBytes());
+            }
+        }
+    });
+    std::cout << "[reclamation] " << name << ": " << batches * batchSize << " objetos en " << micros
+              << " us, pico slab=" << peakChunks * MPointerHeap::CHUNK_SIZE / 1024
+              << " KiB, RSS +" << (peakRss - rssBefore) / 1024 << " KiB" << std::endl;
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Liberación inmediata contra el barrido en segundo plano
+static void benchmarkReclamation() {
+    runReclamation<20>("inmediato", CollectionMode::Immediate);
+    runReclamation<21>("barrido en segundo plano", CollectionMode::Background);
+}
+
+// Copias en un solo hilo con cada política de compilación
+template <typename Policy>
+static double runPolicyCopies(int copies) {
+    MPointer<RcPayload<30>, Policy> shared = MPointer<RcPayload<30>, Policy>::New();
+    return measureMicros(1, [&shared, copies]() {
+        for (int i = 0; i < copies; i++) {
+            MPointer<RcPayload<30>, Policy> copy = shared;
+        }
+    });
+}
+
+static void benchmarkPolicies() {
+    const int copies = 1000000;
+    std::cout << "[policies] " << copies << " copias: GC=" << runPolicyCopies<MPointerDefaultPolicy>(copies)
+              << " us, atomica=" << runPolicyCopies<MPointerAtomicPolicy>(copies)
+              << " us, un hilo=" << runPolicyCopies<MPointerSingleThreadedPolicy>(copies) << " us" << std::endl;
+}
+
+// Costo del tracer: New + liberación inmediata con el tracer apagado y encendido
+static void benchmarkTrace() {
+    const int size = 1000000;
+    MPointerGC<BurstPayload<40>>::getInstance()->setCollectionMode(CollectionMode::Immediate);
+    auto churn = []() {
+        for (int i = 0; i < size; i++) {
+            MPointer<BurstPayload<40>>::New();
+        }
+    };
+    double disabled = measureMicros(1, churn);
+    MPointerTraceDumper dumper("/tmp/mpointer_trace.bin", std::chrono::milliseconds(10));
+    MPointerTrace::setEnabled(true);
+    double enabled = measureMicros(1, churn);
+    MPointerTrace::setEnabled(false);
+    std::cout << "[trace] " << size << " New/free: apagado=" << disabled << " us, encendido=" << enabled
+              << " us, descartados=" << MPointerTrace::getDropped() << std::endl;
+}
+
+// Costo del profiler de reservas: New + liberación inmediata sin muestreo y con el intervalo por defecto
+static void benchmarkProfiler() {
+    const int size = 2000000;
+    MPointerGC<BurstPayload<40>>::getInstance()->setCollectionMode(CollectionMode::Immediate);
+    auto churn = []() {
+        for (int i = 0; i < size; i++) {
+            MPointer<BurstPayload<40>>::New();
+        }
+    };
+    size_t previous = MPointerAllocationProfiler::getSamplingInterval();
+    MPointerAllocationProfiler::setSamplingInterval(0);
+    churn();  // Calentamiento del slab
+    double disabled = measureMicros(3, churn);
+    MPointerAllocationProfiler::setSamplingInterval(MPointerAllocationProfiler::DEFAULT_INTERVAL);
+    double enabled = measureMicros(3, churn);
+    size_t samples = 0;
+    for (auto& site : MPointerAllocationProfiler::getSites()) {
+        samples += site.second.samples;
+    }
+    MPointerAllocationProfiler::setSamplingInterval(previous);
+    std::cout << "[profiler] " << size << " New/free: apagado=" << disabled << " us, muestreo cada "
+              << MPointerAllocationProfiler::DEFAULT_INTERVAL << " B=" << enabled << " us ("
+              << (enabled - disabled) * 100.0 / disabled << "%), muestras=" << samples << std::endl;
+}
+
+int main(int argc, char** argv) {
+    struct Benchmark {
+        const char* name;
+        void (*run)();
+    };
+    const Benchmark benchmarks[] = {
+        {"compaction", benchmarkCompaction},
+        {"relayout", benchmarkRelayout},
+        {"incremental", benchmarkIncremental},
+        {"parallel-sweep", benchmarkParallelSweep},
+        {"deferred-rc", benchmarkDeferredRefCounting},
+        {"biased-rc", benchmarkBiasedRefCounting},
+        {"triggers", benchmarkTriggers},
+        {"reclamation", benchmarkReclamation},
+        {"policies", benchmarkPolicies},
+        {"trace", benchmarkTrace},
+        {"profiler", benchmarkProfiler},
+    };
+
+    // MPOINTER_CHROME_TRACE=archivo.json guarda la actividad del GC para chrome://tracing
+    // (el benchmark "trace" maneja el tracer por su cuenta, conviene excluirlo)
+    std::unique_ptr<MPointerChromeTrace> chromeTrace;
+    if (const char* tracePath = std::getenv("MPOINTER_CHROME_TRACE")) {
+        chromeTrace = std::make_unique<MPointerChromeTrace>(tracePath);
+    }
+
+    // MPOINTER_ALLOC_PROFILE=archivo guarda los sitios de New muestreados (folded stacks, en bytes)
+    const char* profilePath = std::getenv("MPOINTER_ALLOC_PROFILE");
+    if (profilePath != nullptr) {
+        MPointerAllocationProfiler::setSamplingInterval(MPointerAllocationProfiler::DEFAULT_INTERVAL);
+    }
+
+    for (const Benchmark& benchmark : benchmarks) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++) {
+            selected = selected || std::strcmp(argv[i], benchmark.name) == 0;
+        }
+        if (selected) {
+            benchmark.run();
+        }
+    }
+    if (profilePath != nullptr) {
+        MPointerAllocationProfiler::writeFolded(profilePath);
+    }
+    return 0;
+}
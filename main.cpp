@@ -1,47 +1,497 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
 #include <stdexcept> // Para manejar excepciones
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "MPointer.h"
+#include "MPointerTrace.h"
+#include "MPointerChromeTrace.h"
+#include "MPointerProfiler.h"
+#include "MPointerRecorder.h"
+#include "MPointerWorkload.h"
 #include "DoubleLinkedLIst.h"
 
+// Generador de carga para MPointer / MPointerGC.
+// Cada hilo ejecuta operaciones: reservar un objeto (tamaño y vida sorteados), copiar un MPointer compartido
+// por otro hilo y, cada tanto, armar y ordenar una DoublyLinkedList<int>. Al final reporta el throughput,
+// los percentiles de latencia por operación, las pausas del GC y el pico de memoria residente.
+// Con la misma configuración y semilla cada hilo repite la misma secuencia de operaciones.
+// Uso: ./Proyecto1_Datos2_Mpointers [--opcion=valor ...]   (--help muestra las opciones)
 
-// Programa principal para probar la lista doblemente enlazada
-int main() {
-    {
-        DoublyLinkedList<int> list;
+namespace {
+
+constexpr size_t SHARED_SLOTS = 1024;   // MPointers que los hilos se pasan entre sí (por clase de tamaño)
+constexpr size_t SHARED_STRIPES = 64;   // Mutexes que protegen los slots compartidos
+
+// Distribución de enteros: "fixed:N", "uniform:A-B" o "exp:MEDIA"
+struct Distribution {
+    enum class Kind { Fixed, Uniform, Exponential } kind = Kind::Fixed;
+    double a = 0;
+    double b = 0;
+
+    static Distribution parse(const std::string& text) {
+        Distribution result;
+        size_t colon = text.find(':');
+        std::string name = text.substr(0, colon);
+        std::string args = colon == std::string::npos ? "" : text.substr(colon + 1);
+        if (name == "fixed") {
+            result.kind = Kind::Fixed;
+            result.a = std::stod(args);
+        } else if (name == "uniform") {
+            size_t dash = args.find('-');
+            if (dash == std::string::npos) {
+                throw std::invalid_argument("uniform necesita A-B: " + text);
+            }
+            result.kind = Kind::Uniform;
+            result.a = std::stod(args.substr(0, dash));
+            result.b = std::stod(args.substr(dash + 1));
+        } else if (name == "exp") {
+            result.kind = Kind::Exponential;
+            result.a = std::stod(args);
+        } else {
+            throw std::invalid_argument("distribucion desconocida: " + text);
+        }
+        return result;
+    }
+
+    uint64_t sample(std::mt19937_64& random) const {
+        switch (kind) {
+            case Kind::Uniform:
+                return std::uniform_int_distribution<uint64_t>(static_cast<uint64_t>(a), static_cast<uint64_t>(b))(random);
+            case Kind::Exponential:
+                return a > 0 ? static_cast<uint64_t>(std::exponential_distribution<double>(1.0 / a)(random)) : 0;
+            case Kind::Fixed:
+            default:
+                return static_cast<uint64_t>(a);
+        }
+    }
+
+    std::string describe() const {
+        switch (kind) {
+            case Kind::Uniform:
+                return "uniform:" + std::to_string(static_cast<uint64_t>(a)) + "-" + std::to_string(static_cast<uint64_t>(b));
+            case Kind::Exponential:
+                return "exp:" + std::to_string(static_cast<uint64_t>(a));
+            case Kind::Fixed:
+            default:
+                return "fixed:" + std::to_string(static_cast<uint64_t>(a));
+        }
+    }
+};
+
+struct WorkloadConfig {
+    size_t threads = 4;
+    size_t operations = 200000;     // Por hilo
+    double rate = 0;                // Operaciones por segundo por hilo (0 = lo más rápido posible)
+    Distribution size = Distribution::parse("uniform:16-256");  // Bytes
+    Distribution lifetime = Distribution::parse("exp:1000");    // En operaciones del mismo hilo
+    double share = 0.1;             // Fracción de copias de MPointers compartidos (y de objetos publicados)
+    size_t listSize = 64;
+    size_t listEvery = 1000;        // Cada cuántas operaciones se ordena una lista (0 = nunca)
+    std::string sort = "insertion";
+    MPointerCollectorOptions collector;  // collectEvery cuenta operaciones de cada hilo
+    uint64_t seed = 1;
+};
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " [--opcion=valor ...]\n"
+              << "  --threads=N          hilos de carga (4)\n"
+              << "  --ops=N              operaciones por hilo (200000)\n"
+              << "  --rate=N             operaciones por segundo por hilo, 0 = sin limite (0)\n"
+              << "  --size=DIST          tamaño de los objetos en bytes (uniform:16-256)\n"
+              << "  --lifetime=DIST      vida de los objetos en operaciones del hilo (exp:1000)\n"
+              << "  --share=P            fraccion de copias de MPointers compartidos entre hilos (0.1)\n"
+              << "  --list-size=N        nodos de cada DoublyLinkedList ordenada (64)\n"
+              << "  --list-every=N       operaciones entre ordenamientos, 0 = nunca (1000)\n"
+              << "  --sort=ALG           insertion | bubble | quick (insertion)\n"
+              << MPointerCollectorOptions::USAGE
+              << "  --seed=N             semilla (1)\n"
+              << "DIST: fixed:N | uniform:A-B | exp:MEDIA\n"
+              << "Variables de entorno: MPOINTER_CHROME_TRACE, MPOINTER_ALLOC_PROFILE, MPOINTER_HEAP_SNAPSHOT,\n"
+              << "MPOINTER_RECORD (grabacion para mpointer_replay)\n";
+}
+
+WorkloadConfig parseArguments(int argc, char** argv) {
+    WorkloadConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--help" || argument == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        if (argument.compare(0, 2, "--") != 0) {
+            throw std::invalid_argument("argumento invalido: " + argument);
+        }
+        size_t equals = argument.find('=');
+        std::string key = argument.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+        std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+        if (config.collector.parse(key, value)) {
+            continue;
+        }
+        if (key == "threads") {
+            config.threads = std::max<size_t>(1, std::stoul(value));
+        } else if (key == "ops") {
+            config.operations = std::stoul(value);
+        } else if (key == "rate") {
+            config.rate = std::stod(value);
+        } else if (key == "size") {
+            config.size = Distribution::parse(value);
+        } else if (key == "lifetime") {
+            config.lifetime = Distribution::parse(value);
+        } else if (key == "share") {
+            config.share = std::min(1.0, std::max(0.0, std::stod(value)));
+        } else if (key == "list-size") {
+            config.listSize = std::stoul(value);
+        } else if (key == "list-every") {
+            config.listEvery = std::stoul(value);
+        } else if (key == "sort") {
+            if (value != "insertion" && value != "bubble" && value != "quick") {
+                throw std::invalid_argument("algoritmo desconocido: " + value);
+            }
+            config.sort = value;
+        } else if (key == "seed") {
+            config.seed = std::stoull(value);
+        } else {
+            throw std::invalid_argument("opcion desconocida: --" + key);
+        }
+    }
+    config.collector.validate();
+    return config;
+}
+
+// Histograma log-lineal de latencias (en marcas de MPointerTrace::now()): 32 sub-buckets por potencia de 2,
+// error relativo menor a 1/32
+class LatencyHistogram {
+    static constexpr int SUB_BITS = 5;
+    static constexpr size_t LINEAR = size_t(2) << SUB_BITS;  // Valores exactos por debajo de 64
+    std::vector<uint64_t> counts = std::vector<uint64_t>(LINEAR + (64 - SUB_BITS - 1) * (LINEAR / 2));
+    uint64_t total = 0;
+
+    static size_t indexOf(uint64_t value) {
+        if (value < LINEAR) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        return static_cast<size_t>(msb - SUB_BITS) * (LINEAR / 2) + static_cast<size_t>(value >> (msb - SUB_BITS));
+    }
+
+    // Límite superior de los valores del bucket
+    static uint64_t upperBound(size_t index) {
+        if (index < LINEAR) {
+            return index;
+        }
+        int msb = static_cast<int>(index / (LINEAR / 2)) + SUB_BITS - 1;
+        uint64_t mantissa = index % (LINEAR / 2) + LINEAR / 2;
+        return ((mantissa + 1) << (msb - SUB_BITS)) - 1;
+    }
+
+public:
+    void record(uint64_t value) {
+        counts[indexOf(value)]++;
+        total++;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts.size(); i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    uint64_t percentile(double fraction) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return upperBound(i);
+            }
+        }
+        return upperBound(counts.size() - 1);
+    }
+};
+
+// MPointers que un hilo publica y otros copian
+template <size_t Index>
+struct SharedSlots {
+    std::mutex stripes[SHARED_STRIPES];
+    std::vector<MPointer<MPointerClassPayload<Index>>> slots = std::vector<MPointer<MPointerClassPayload<Index>>>(SHARED_SLOTS);
+};
+
+template <size_t... I>
+auto makeSharedTable(std::index_sequence<I...>) -> std::tuple<SharedSlots<I>...>;
+
+using SharedTable = decltype(makeSharedTable(std::make_index_sequence<MPOINTER_SIZE_CLASS_COUNT>{}));
+
+// MPointers que sostiene un hilo, con slots libres para reutilizar
+template <size_t Index>
+struct HeldSlots {
+    std::vector<MPointer<MPointerClassPayload<Index>>> held;
+    std::vector<uint32_t> freeSlots;
+};
+
+template <size_t... I>
+auto makeHeldTable(std::index_sequence<I...>) -> std::tuple<HeldSlots<I>...>;
+
+using HeldTable = decltype(makeHeldTable(std::make_index_sequence<MPOINTER_SIZE_CLASS_COUNT>{}));
+
+struct Expiry {
+    uint64_t operation;  // Operación del hilo en la que se suelta
+    uint32_t sizeClass;
+    uint32_t slot;
+
+    bool operator>(const Expiry& other) const {
+        return operation > other.operation;
+    }
+};
+
+struct ThreadResult {
+    LatencyHistogram allocate;
+    LatencyHistogram copy;
+    LatencyHistogram sort;
+    uint64_t operations = 0;
+};
+
+class Workload {
+    const WorkloadConfig& config;
+    SharedTable shared;
+
+public:
+    explicit Workload(const WorkloadConfig& config) : config(config) {}
+
+    // Ejecuta las operaciones de un hilo
+    void run(size_t threadIndex, uint64_t startTicks, ThreadResult& result) {
+        std::mt19937_64 random(config.seed * 0x9E3779B97F4A7C15ull + threadIndex);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<size_t> anySlot(0, SHARED_SLOTS - 1);
+        HeldTable heldTable;
+        std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> expiries;
+        double ticksPerOperation = config.rate > 0 ? MPointerTrace::ticksPerMicro() * 1e6 / config.rate : 0;
 
-        list.append(10);
-        list.append(7);
-        list.append(8);
-        list.append(9);
-        list.append(178);
-        list.append(5);
+        for (uint64_t operation = 0; operation < config.operations; operation++) {
+            // Con tasa fija la latencia se mide desde el instante programado, no desde que el hilo quedó libre
+            // (así una pausa larga cuenta para todas las operaciones que retrasó)
+            uint64_t start = MPointerTrace::now();
+            if (ticksPerOperation > 0) {
+                uint64_t scheduled = startTicks + static_cast<uint64_t>(static_cast<double>(operation) * ticksPerOperation);
+                while (MPointerTrace::now() < scheduled) {
+                    std::this_thread::yield();
+                }
+                start = scheduled;
+            }
 
-        int n = list.size();
-        insertionSort(list);  // Cambiar por el algoritmo a probar (bubbleSort, quickSort, insertionsort)
+            while (!expiries.empty() && expiries.top().operation <= operation) {
+                Expiry expired = expiries.top();
+                expiries.pop();
+                withSizeClass(expired.sizeClass, [&](auto index) {
+                    auto& slots = std::get<decltype(index)::value>(heldTable);
+                    slots.held[expired.slot] = nullptr;
+                    slots.freeSlots.push_back(expired.slot);
+                });
+            }
 
-        // Mostrar la lista ordenada
-        for (int i = 0; i < n; i++) {
-            std::cout << list.get(i) << " ";
+            size_t sizeClass = mpointerSizeClass(config.size.sample(random));
+            uint64_t lifetime = config.lifetime.sample(random);
+            bool copy = unit(random) < config.share;
+            bool publish = !copy && unit(random) < config.share;
+            size_t sharedSlot = anySlot(random);
+            withSizeClass(sizeClass, [&](auto index) {
+                constexpr size_t I = decltype(index)::value;
+                auto& slots = std::get<I>(heldTable);
+                auto& table = std::get<I>(shared);
+                MPointer<MPointerClassPayload<I>> pointer;
+                if (copy) {
+                    std::lock_guard<std::mutex> lock(table.stripes[sharedSlot % SHARED_STRIPES]);
+                    pointer = table.slots[sharedSlot];
+                } else {
+                    pointer = MPointer<MPointerClassPayload<I>>::New();
+                    pointer->bytes[0] = static_cast<unsigned char>(operation);
+                    if (publish) {
+                        std::lock_guard<std::mutex> lock(table.stripes[sharedSlot % SHARED_STRIPES]);
+                        table.slots[sharedSlot] = pointer;
+                    }
+                }
+                if (lifetime > 0 && pointer != nullptr) {
+                    uint32_t slot;
+                    if (slots.freeSlots.empty()) {
+                        slot = static_cast<uint32_t>(slots.held.size());
+                        slots.held.emplace_back();
+                    } else {
+                        slot = slots.freeSlots.back();
+                        slots.freeSlots.pop_back();
+                    }
+                    slots.held[slot] = pointer;
+                    expiries.push({operation + lifetime, static_cast<uint32_t>(sizeClass), slot});
+                }
+            });
+            if (config.collector.mode == CollectionMode::Manual && config.collector.collectEvery != 0 &&
+                (operation + 1) % config.collector.collectEvery == 0) {
+                collectSizeClasses();
+            }
+            (copy ? result.copy : result.allocate).record(MPointerTrace::now() - start);
+
+            if (config.listEvery != 0 && (operation + 1) % config.listEvery == 0) {
+                uint64_t sortStart = MPointerTrace::now();
+                sortList(random);
+                result.sort.record(MPointerTrace::now() - sortStart);
+            }
+            result.operations++;
         }
-        std::cout << std::endl;
+    }
 
+    // Arma una lista con valores aleatorios y la ordena con el algoritmo configurado
+    void sortList(std::mt19937_64& random) {
+        DoublyLinkedList<int> list;
+        std::uniform_int_distribution<int> values(0, 1000000);
+        for (size_t i = 0; i < config.listSize; i++) {
+            list.append(values(random));
+        }
+        if (config.sort == "bubble") {
+            bubbleSort(list);
+        } else if (config.sort == "quick") {
+            quickSort(list);
+        } else {
+            insertionSort(list);
+        }
+    }
+
+    // Suelta los MPointers compartidos
+    void clearShared() {
+        forEachSizeClass([&](auto index) {
+            auto& table = std::get<decltype(index)::value>(shared);
+            for (size_t i = 0; i < SHARED_SLOTS; i++) {
+                std::lock_guard<std::mutex> lock(table.stripes[i % SHARED_STRIPES]);
+                table.slots[i] = nullptr;
+            }
+        });
+    }
+};
+
+void printLatency(const char* name, const LatencyHistogram& histogram, double ticksPerMicro) {
+    auto micros = [ticksPerMicro](uint64_t ticks) { return static_cast<double>(ticks) / ticksPerMicro; };
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(12) << histogram.count()
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << micros(histogram.percentile(0.50))
+              << std::setw(12) << micros(histogram.percentile(0.99))
+              << std::setw(12) << micros(histogram.percentile(0.999))
+              << std::setw(12) << micros(histogram.percentile(1.0)) << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
 
-        /*
-        MPointer<int> mp1 = MPointer<int>::New();
-        MPointer<int> mp2 = MPointer<int>::New();
+} // namespace
 
+int main(int argc, char** argv) {
+    WorkloadConfig config;
+    try {
+        config = parseArguments(argc, argv);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
 
-        *mp1 = 100;
-        mp2 = 55;
+    // MPOINTER_CHROME_TRACE=archivo.json guarda la actividad del GC para chrome://tracing
+    std::unique_ptr<MPointerChromeTrace> chromeTrace;
+    if (const char* tracePath = std::getenv("MPOINTER_CHROME_TRACE")) {
+        chromeTrace = std::make_unique<MPointerChromeTrace>(tracePath);
+    }
+    // MPOINTER_ALLOC_PROFILE=archivo guarda los sitios de New muestreados (folded stacks, en bytes)
+    const char* profilePath = std::getenv("MPOINTER_ALLOC_PROFILE");
+    if (profilePath != nullptr) {
+        MPointerAllocationProfiler::setSamplingInterval(MPointerAllocationProfiler::DEFAULT_INTERVAL);
+    }
 
-        MPointer<int> mp3 = mp2; //(shallow copy)
+    std::cout << "config: threads=" << config.threads << " ops=" << config.operations << " rate=" << config.rate
+              << " size=" << config.size.describe() << " lifetime=" << config.lifetime.describe()
+              << " share=" << config.share << " list-size=" << config.listSize << " list-every=" << config.listEvery
+              << " sort=" << config.sort << " " << config.collector.describe() << " seed=" << config.seed << std::endl;
 
-        MPointerGC<int>::getInstance()->debug();
+    config.collector.applyAll<Node<int>>();
+    // MPOINTER_RECORD=archivo graba las reservas, copias y destrucciones de la carga para mpointer_replay
+    const char* recordPath = std::getenv("MPOINTER_RECORD");
+    if (recordPath != nullptr) {
+        MPointerAllocationRecorder::start(recordPath);
+    }
+    double ticksPerMicro = MPointerTrace::ticksPerMicro();
+    MPointerGCStats before = mpointerCollectorStats<Node<int>>();
+    std::vector<ThreadResult> results(config.threads);
+    uint64_t elapsedTicks;
+    {
+        Workload workload(config);
+        std::vector<std::thread> threads;
+        uint64_t startTicks = MPointerTrace::now();
+        for (size_t i = 0; i < config.threads; i++) {
+            threads.emplace_back([&workload, &results, i, startTicks]() { workload.run(i, startTicks, results[i]); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        elapsedTicks = MPointerTrace::now() - startTicks;
+
+        // MPOINTER_HEAP_SNAPSHOT=archivo guarda los objetos vivos para mpointer_heap_analyzer
+        if (const char* snapshotPath = std::getenv("MPOINTER_HEAP_SNAPSHOT")) {
+            MPointerRuntime::getInstance().writeHeapSnapshot(snapshotPath);
+        }
+        workload.clearShared();
+    }
+    if (recordPath != nullptr) {
+        MPointerAllocationRecorder::stop();  // Todas las referencias de la carga ya se soltaron
+    }
+    MPointerGCStats after = mpointerCollectorStats<Node<int>>();
+
+    // Recolección sincrónica: cada pasada puede soltar los nodos a los que apuntaban los liberados
+    collectSizeClasses();
+    while (MPointerGC<Node<int>>::getInstance()->collect().freed != 0) {
+    }
+    chromeTrace.reset();
+    if (profilePath != nullptr) {
+        MPointerAllocationProfiler::writeFolded(profilePath);
+    }
 
-        */
+    ThreadResult total;
+    for (const ThreadResult& result : results) {
+        total.allocate.merge(result.allocate);
+        total.copy.merge(result.copy);
+        total.sort.merge(result.sort);
+        total.operations += result.operations;
     }
+    double seconds = static_cast<double>(elapsedTicks) / ticksPerMicro / 1e6;
+    MPointerGCStats pauses = mpointerStatsSince(before, after);
 
-    std::this_thread::sleep_for(std::chrono::seconds(5));  // Pausa para que el GC se ejecute
+    std::cout << "tiempo: " << seconds << " s, operaciones: " << total.operations
+              << ", throughput: " << static_cast<uint64_t>(static_cast<double>(total.operations) / seconds) << " ops/s"
+              << ", reservas: " << static_cast<uint64_t>(static_cast<double>(pauses.allocations) / seconds) << " /s"
+              << std::endl;
+    std::cout << std::endl << "Latencia por operacion (us):" << std::endl;
+    std::cout << std::left << std::setw(10) << "op" << std::right << std::setw(12) << "cantidad" << std::setw(12)
+              << "p50" << std::setw(12) << "p99" << std::setw(12) << "p999" << std::setw(12) << "max" << std::endl;
+    printLatency("new", total.allocate, ticksPerMicro);
+    printLatency("copy", total.copy, ticksPerMicro);
+    printLatency("sort", total.sort, ticksPerMicro);
 
+    std::cout << std::endl;
+    printPauses(std::cout, pauses);
+    std::cout << std::endl << "Registrados al terminar la carga (incluye basura sin recolectar): " << after.liveObjects
+              << " (" << after.liveBytes << " bytes), pico del heap: " << MPointerRuntime::getInstance().getPeakBytes()
+              << " bytes, pico de memoria residente: " << peakResidentKilobytes() << " KiB" << std::endl;
     return 0;
 }
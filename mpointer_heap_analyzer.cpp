@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "MPointerSnapshot.h"
+
+// Análisis offline de un snapshot de MPointerRuntime::writeHeapSnapshot:
+// tipos con más objetos y memoria, tamaños retenidos, distribución de refCount y ciclos sin raíz.
+// Uso: mpointer_heap_analyzer <snapshot> [top]
+
+namespace {
+
+struct TypeSummary {
+    size_t objects = 0;
+    uint64_t bytes = 0;
+};
+
+// Cubeta del histograma de refCount: 0, 1, 2, 3-4, 5-8, ... (potencias de 2)
+int refCountBucket(int32_t refCount) {
+    if (refCount <= 0) {
+        return 0;
+    }
+    int bucket = 1;
+    for (int64_t limit = 1; refCount > limit; limit *= 2) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::string bucketLabel(int bucket) {
+    if (bucket <= 2) {
+        return std::to_string(bucket);
+    }
+    int from = (1 << (bucket - 2)) + 1;
+    int to = 1 << (bucket - 1);
+    return std::to_string(from) + "-" + std::to_string(to);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <snapshot> [top]" << std::endl;
+        return 1;
+    }
+    size_t top = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 10;
+
+    MPointerHeapSnapshot snapshot;
+    try {
+        snapshot = MPointerHeapSnapshot::read(argv[1]);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<bool> unreachable;
+    std::vector<uint64_t> retained = snapshot.retainedSizes(&unreachable);
+
+    uint64_t totalBytes = 0;
+    size_t cycleObjects = 0;
+    uint64_t cycleBytes = 0;
+    std::vector<TypeSummary> types(snapshot.types.size());
+    std::map<int, size_t> refCounts;
+    for (size_t i = 0; i < snapshot.objects.size(); i++) {
+        const MPointerSnapshotObject& object = snapshot.objects[i];
+        totalBytes += object.size;
+        types[object.type].objects++;
+        types[object.type].bytes += object.size;
+        refCounts[refCountBucket(object.refCount)]++;
+        if (unreachable[i]) {
+            cycleObjects++;
+            cycleBytes += object.size;
+        }
+    }
+
+    std::cout << "Objetos: " << snapshot.objects.size() << ", bytes: " << totalBytes
+              << ", tipos: " << snapshot.types.size() << ", aristas: " << snapshot.edges.size() << std::endl;
+    std::cout << "Sostenidos solo por ciclos (sin referencias externas): " << cycleObjects << " objetos, "
+              << cycleBytes << " bytes" << std::endl;
+
+    std::vector<size_t> order(types.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return types[a].bytes > types[b].bytes; });
+    std::cout << std::endl << "Tipos por memoria:" << std::endl;
+    std::cout << std::setw(12) << "objetos" << std::setw(14) << "bytes" << "  tipo" << std::endl;
+    for (size_t i = 0; i < order.size() && i < top; i++) {
+        const TypeSummary& summary = types[order[i]];
+        const MPointerSnapshotType& type = snapshot.types[order[i]];
+        std::cout << std::setw(12) << summary.objects << std::setw(14) << summary.bytes << "  " << type.name
+                  << (type.edgesKnown ? "" : " (sin aristas)") << std::endl;
+    }
+
+    std::vector<size_t> biggest(snapshot.objects.size());
+    for (size_t i = 0; i < biggest.size(); i++) {
+        biggest[i] = i;
+    }
+    size_t shown = std::min(top, biggest.size());
+    std::partial_sort(biggest.begin(), biggest.begin() + shown, biggest.end(),
+                      [&](size_t a, size_t b) { return retained[a] > retained[b]; });
+    std::cout << std::endl << "Objetos con mayor tamaño retenido:" << std::endl;
+    std::cout << std::setw(14) << "retenido" << std::setw(10) << "id" << std::setw(10) << "refCount" << "  tipo"
+              << std::endl;
+    for (size_t i = 0; i < shown; i++) {
+        const MPointerSnapshotObject& object = snapshot.objects[biggest[i]];
+        std::cout << std::setw(14) << retained[biggest[i]] << std::setw(10) << object.id << std::setw(10)
+                  << object.refCount << "  " << snapshot.types[object.type].name << std::endl;
+    }
+
+    std::cout << std::endl << "Distribución de refCount:" << std::endl;
+    for (auto& bucket : refCounts) {
+        std::cout << std::setw(12) << bucketLabel(bucket.first) << std::setw(12) << bucket.second << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "MPointer.h"
+#include "MPointerRecorder.h"
+#include "MPointerWorkload.h"
+
+// Reproduce una grabación de MPointerAllocationRecorder (MPOINTER_RECORD) contra la configuración de
+// MPointerGC que se pida, y reporta el tiempo, el pico de memoria y las pausas del GC.
+// Cada tipo grabado se reemplaza por un objeto de su clase de tamaño (MPointerWorkload.h); los eventos se
+// aplican en el orden global de la grabación, en un solo hilo o en un hilo por cada hilo grabado.
+// Uso: mpointer_replay <grabacion> [--threads=serial|recorded] [opciones del GC]
+
+namespace {
+
+template <size_t Index>
+using ReplayHandles = std::unordered_map<uint64_t, std::vector<MPointer<MPointerClassPayload<Index>>>>;
+
+template <size_t... I>
+auto makeHandleTable(std::index_sequence<I...>) -> std::tuple<ReplayHandles<I>...>;
+
+// (tipo, ID) -> MPointers que la grabación tiene vivos para ese objeto
+using HandleTable = decltype(makeHandleTable(std::make_index_sequence<MPOINTER_SIZE_CLASS_COUNT>{}));
+
+struct ReplayOptions {
+    bool recordedThreads = false;
+    MPointerCollectorOptions collector;  // collectEvery cuenta eventos
+};
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " <grabacion> [--opcion=valor ...]\n"
+              << "  --threads=MODO       serial | recorded: un hilo, o uno por hilo grabado (serial)\n"
+              << MPointerCollectorOptions::USAGE;
+}
+
+class Replayer {
+    const MPointerRecording& recording;
+    const std::vector<MPointerRecordEvent>& events;
+    const ReplayOptions& options;
+    std::vector<size_t> typeClasses;  // Clase de tamaño de cada tipo grabado
+    HandleTable handles;
+    std::atomic<size_t> cursor{0};  // Siguiente evento a aplicar (modo recorded)
+
+public:
+    size_t preexisting = 0;  // Objetos creados antes de empezar la grabación (vistos en una copia)
+    size_t unmatched = 0;    // Destrucciones de objetos que la grabación nunca mostró
+    size_t liveObjects = 0;
+    size_t liveBytes = 0;    // Con los tamaños grabados (sizeof(T) original)
+    size_t peakLiveBytes = 0;
+    size_t handoffs = 0;     // Tramos de eventos seguidos del mismo hilo (modo recorded)
+
+    Replayer(const MPointerRecording& recording, const std::vector<MPointerRecordEvent>& events,
+             const ReplayOptions& options)
+        : recording(recording), events(events), options(options) {
+        for (const MPointerRecordType& type : recording.types) {
+            typeClasses.push_back(mpointerSizeClass(type.size));
+        }
+    }
+
+    // Aplica un evento: New crea el objeto, Copy suma una referencia y Destroy suelta una
+    void apply(size_t position) {
+        const MPointerRecordEvent& event = events[position];
+        uint64_t key = (static_cast<uint64_t>(event.type) << 32) | static_cast<uint32_t>(event.object);
+        size_t size = recording.types[event.type].size;
+        withSizeClass(typeClasses[event.type], [&](auto index) {
+            auto& table = std::get<decltype(index)::value>(handles);
+            switch (event.kind()) {
+                case MPointerRecordKind::New:
+                    created(table[key], size);
+                    break;
+                case MPointerRecordKind::Copy: {
+                    auto& pointers = table[key];
+                    if (pointers.empty()) {
+                        created(pointers, size);  // Su primera referencia es anterior a la grabación
+                        preexisting++;
+                    }
+                    pointers.push_back(pointers.back());
+                    break;
+                }
+                case MPointerRecordKind::Destroy: {
+                    auto it = table.find(key);
+                    if (it == table.end()) {
+                        unmatched++;
+                        break;
+                    }
+                    it->second.pop_back();
+                    if (it->second.empty()) {
+                        table.erase(it);
+                        liveObjects--;
+                        liveBytes -= size;
+                    }
+                    break;
+                }
+            }
+        });
+        size_t every = options.collector.collectEvery;
+        if (options.collector.mode == CollectionMode::Manual && every != 0 && (position + 1) % every == 0) {
+            collectSizeClasses();
+        }
+    }
+
+    template <typename Pointers>
+    void created(Pointers& pointers, size_t size) {
+        pointers.push_back(Pointers::value_type::New());
+        if (pointers.size() == 1) {
+            liveObjects++;
+            liveBytes += size;
+            peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+        }
+    }
+
+    void runSerial() {
+        for (size_t position = 0; position < events.size(); position++) {
+            apply(position);
+        }
+    }
+
+    // Un hilo por hilo grabado; cada uno espera su turno, así el orden global se mantiene y cada MPointer
+    // se copia y se suelta desde el mismo hilo que en la grabación (importa para el conteo sesgado o diferido).
+    // El turno pasa una vez por tramo de eventos seguidos del mismo hilo, no por evento; aun así cada paso
+    // de turno es un cambio de hilo que el modo serial no paga (ver handoffs en el reporte).
+    void runRecordedThreads() {
+        std::map<uint16_t, std::vector<std::pair<size_t, size_t>>> runs;  // Hilo -> tramos [inicio, fin)
+        for (size_t start = 0; start < events.size();) {
+            size_t end = start + 1;
+            while (end < events.size() && events[end].thread == events[start].thread) {
+                end++;
+            }
+            runs[events[start].thread].emplace_back(start, end);
+            handoffs++;
+            start = end;
+        }
+        std::vector<std::thread> threads;
+        for (auto& entry : runs) {
+            const std::vector<std::pair<size_t, size_t>>* mine = &entry.second;
+            threads.emplace_back([this, mine]() {
+                for (const auto& run : *mine) {
+                    while (cursor.load(std::memory_order_acquire) != run.first) {
+                        std::this_thread::yield();
+                    }
+                    for (size_t position = run.first; position < run.second; position++) {
+                        apply(position);
+                    }
+                    cursor.store(run.second, std::memory_order_release);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    size_t threadCount() const {
+        std::vector<bool> seen(65536);
+        size_t count = 0;
+        for (const MPointerRecordEvent& event : events) {
+            if (!seen[event.thread]) {
+                seen[event.thread] = true;
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Suelta las referencias que la grabación dejó vivas
+    void clear() {
+        forEachSizeClass([this](auto index) {
+            std::get<decltype(index)::value>(handles).clear();
+        });
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::string(argv[1]) == "--help") {
+        printUsage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    ReplayOptions options;
+    try {
+        for (int i = 2; i < argc; i++) {
+            std::string argument = argv[i];
+            size_t equals = argument.find('=');
+            if (argument.compare(0, 2, "--") != 0) {
+                throw std::invalid_argument("argumento invalido: " + argument);
+            }
+            std::string key = argument.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+            std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+            if (options.collector.parse(key, value)) {
+                continue;
+            }
+            if (key == "threads" && (value == "serial" || value == "recorded")) {
+                options.recordedThreads = value == "recorded";
+            } else {
+                throw std::invalid_argument("opcion desconocida: " + argument);
+            }
+        }
+        options.collector.validate();
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    MPointerRecording recording;
+    try {
+        recording = MPointerRecording::read(argv[1]);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    recording.sortByTime();
+    const std::vector<MPointerRecordEvent>& events = recording.events;
+    double recordedMicros = events.empty() ? 0 : static_cast<double>(events.back().ticks()) / recording.ticksPerMicro;
+
+    options.collector.applyAll();
+    Replayer replayer(recording, events, options);
+    std::cout << "grabacion: " << events.size() << " eventos, " << recording.types.size() << " tipos, "
+              << replayer.threadCount() << " hilos, " << recordedMicros / 1e6 << " s" << std::endl;
+    std::cout << "config: threads=" << (options.recordedThreads ? "recorded" : "serial") << " "
+              << options.collector.describe() << std::endl;
+
+    MPointerGCStats before = mpointerCollectorStats();
+    auto start = std::chrono::steady_clock::now();
+    if (options.recordedThreads) {
+        replayer.runRecordedThreads();
+    } else {
+        replayer.runSerial();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    MPointerGCStats after = mpointerCollectorStats();
+    size_t remaining = replayer.liveObjects;
+    replayer.clear();
+    collectSizeClasses();
+
+    MPointerGCStats pauses = mpointerStatsSince(before, after);
+    std::cout << "tiempo: " << seconds << " s, " << static_cast<uint64_t>(static_cast<double>(events.size()) / seconds)
+              << " eventos/s, reservas: " << pauses.allocations << ", liberadas: " << pauses.frees << std::endl;
+    if (options.recordedThreads) {
+        std::cout << "cambios de turno entre hilos: " << replayer.handoffs
+                  << " (el tiempo incluye esos cambios de hilo: no es comparable con threads=serial)" << std::endl;
+    }
+    std::cout << "objetos previos a la grabacion: " << replayer.preexisting
+              << ", destrucciones sin objeto: " << replayer.unmatched
+              << ", vivos al terminar la grabacion: " << remaining << std::endl;
+    std::cout << "pico alcanzable: " << replayer.peakLiveBytes << " bytes (tamaños grabados), pico del heap: "
+              << MPointerRuntime::getInstance().getPeakBytes() << " bytes (clases de tamaño, con basura sin recolectar)"
+              << ", pico de memoria residente: " << peakResidentKilobytes() << " KiB (la grabacion cargada ocupa "
+              << events.size() * sizeof(MPointerRecordEvent) / 1024 << " KiB)" << std::endl;
+    std::cout << std::endl;
+    printPauses(std::cout, pauses);
+    return 0;
+}
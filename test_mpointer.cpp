@@ -1,6 +1,24 @@
 #include <gtest/gtest.h>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "MPointer.h"
 #include "LinkedList.h"
+#include "MPointerScope.h"
+#include "MPointerHeap.h"
+#include "MPointerWorkers.h"
+#include "MPointerRuntime.h"
+#include "MPointerPolicy.h"
+#include "MPointerTrace.h"
+#include "MPointerChromeTrace.h"
+#include "MPointerSnapshot.h"
+#include "MPointerProfiler.h"
+#include "MPointerRecorder.h"
+#include "DoubleLinkedLIst.h"
 
 ///////////////////////////////////////////////////////LinkedList///////////////////////////////////////////////////////
 // Caso de prueba: Insertar un nodo y verificar que su ID y dirección son correctos
@@ -93,6 +111,23 @@ TEST(LinkedListTest, FindNonExistentByAddress) {
     delete fakeValue;
 }
 
+// Caso de prueba: removeIf elimina en una pasada todos los nodos que cumplen el predicado
+TEST(LinkedListTest, RemoveIf) {
+    LinkedList<int> list;
+    int values[4] = {1, 2, 3, 4};
+    int ids[4];
+    for (int i = 0; i < 4; i++) {
+        list.insert(&values[i], ids[i]);
+    }
+
+    list.removeIf([](auto& node) { return *node.address % 2 == 0; });  // Elimina los pares
+
+    EXPECT_EQ(list.getAddressById(ids[0]), &values[0]);
+    EXPECT_EQ(list.getAddressById(ids[1]), nullptr);
+    EXPECT_EQ(list.getAddressById(ids[2]), &values[2]);
+    EXPECT_EQ(list.getAddressById(ids[3]), nullptr);
+}
+
 ///////////////////////////////////////////////////////MPointer/////////////////////////////////////////////////////////
 // Caso de prueba: Crear un nuevo MPointer y verificar que el puntero no sea nulo
 TEST(MPointerTest, CreateNewMPointer) {
@@ -184,7 +219,7 @@ TEST(GarbageCollectorTest, GarbageCollectorFreesMemoryCorrectly) {
 
     ptr1.~MPointer();  // Destruir ptr1, RefCount debe llegar a 0
 
-    std::this_thread::sleep_for(std::chrono::seconds(2));  // Esperar que el GC limpie la memoria
+    MPointerGC<int>::getInstance()->collect();  // Recolección sincrónica, sin esperar al hilo
     MPointerGC<int>::getInstance()->debug();  // Verifica que el GC liberó la memoria correctamente
 }
 
@@ -193,9 +228,1385 @@ TEST(GarbageCollectorTest, GarbageCollectorThreadRunning) {
     auto ptr1 = MPointer<int>::New();
     *ptr1 = 100;
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));  // Asegurar que el hilo del GC esté activo
     EXPECT_NE(MPointerGC<int>::getInstance(), nullptr);  // GC debe estar activo
+    EXPECT_EQ(MPointerGC<int>::getInstance()->getCollectionMode(), CollectionMode::Background);
+}
+
+// Tipo auxiliar con su propio GC para las pruebas de reciclaje
+struct RecycledNode {
+    int value = 0;
+};
+
+//Con el pool activo, FreeMemory guarda la memoria y New() la reutiliza sin llamar al allocator
+TEST(GarbageCollectorTest, RecyclePoolReusesFreedObjects) {
+    MPointerGC<RecycledNode>* gc = MPointerGC<RecycledNode>::getInstance();
+    gc->setRecycleCapacity(16);
+
+    size_t callsBefore = gc->getAllocatorCalls();
+    for (int i = 0; i < 1000; i++) {
+        auto ptr = MPointer<RecycledNode>::New();
+        ptr->value = i;
+        int id = ptr.getId();
+        ptr = nullptr;         // refCount 0
+        gc->FreeMemory(id);    // El objeto destruido va al pool
+    }
+
+    // En estado estable casi todo sale del pool (el hilo del GC puede recortarlo alguna vez)
+    EXPECT_LE(gc->getAllocatorCalls() - callsBefore, 5u);
+    EXPECT_GE(gc->getRecycleHits(), 995u);
+
+    gc->setRecycleCapacity(0);  // Desactivar el pool libera lo que quede
+    EXPECT_EQ(gc->getRecyclePoolSize(), 0u);
+}
+
+// Tipo auxiliar cuyo constructor lanza a partir de cierta cantidad de objetos construidos
+struct ThrowingNode {
+    static inline int constructed = 0;
+    static inline int failAfter = -1;  // -1 = nunca lanza
+    ThrowingNode() {
+        if (failAfter >= 0 && constructed >= failAfter) {
+            throw std::runtime_error("ThrowingNode");
+        }
+        ++constructed;
+    }
+};
+
+//Si el constructor de T lanza, la memoria vuelve al pool y los bytes no cuentan para el umbral
+TEST(GarbageCollectorTest, ThrowingConstructorReturnsMemory) {
+    MPointerGC<ThrowingNode>* gc = MPointerGC<ThrowingNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);  // Sin hilo del GC que recorte el pool
+    gc->setRecycleCapacity(16);
+    size_t bytesBefore = gc->getBytesSinceCollection();
+
+    ThrowingNode::constructed = 0;
+    ThrowingNode::failAfter = 0;
+    EXPECT_THROW(MPointer<ThrowingNode>::New(), std::runtime_error);
+    EXPECT_EQ(gc->getRecyclePoolSize(), 1u);
+    EXPECT_EQ(gc->getBytesSinceCollection(), bytesBefore);
+
+    // En un bloque, los 3 objetos construidos quedan para el GC y los 5 que faltaban vuelven al pool
+    ThrowingNode::failAfter = 3;
+    EXPECT_THROW(MPointer<ThrowingNode>::NewBlock(8), std::runtime_error);
+    EXPECT_EQ(gc->getRecyclePoolSize(), 6u);
+
+    ThrowingNode::failAfter = -1;
+    gc->setRecycleCapacity(0);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+//El pool nunca guarda más objetos que su capacidad
+TEST(GarbageCollectorTest, RecyclePoolIsBounded) {
+    MPointerGC<RecycledNode>* gc = MPointerGC<RecycledNode>::getInstance();
+    gc->setRecycleCapacity(2);
+
+    std::vector<int> ids;
+    {
+        std::vector<MPointer<RecycledNode>> ptrs;
+        for (int i = 0; i < 5; i++) {
+            ptrs.push_back(MPointer<RecycledNode>::New());
+            ids.push_back(ptrs.back().getId());
+        }
+    }
+    for (int id : ids) {
+        gc->FreeMemory(id);
+    }
+
+    EXPECT_LE(gc->getRecyclePoolSize(), 2u);
+    gc->trimRecyclePool(0);
+    EXPECT_EQ(gc->getRecyclePoolSize(), 0u);
+    gc->setRecycleCapacity(0);
+}
+
+///////////////////////////////////////////////////////MPointerHeap/////////////////////////////////////////////////////
+//Los chunks están alineados a CHUNK_SIZE y un chunk inactivo devuelve sus páginas al sistema operativo
+TEST(MPointerHeapTest, IdleChunksAreReturned) {
+    MPointerHeap& heap = MPointerHeap::getInstance();
+    heap.setHugePages(true);
+    heap.setIdlePeriod(std::chrono::milliseconds(0));
+
+    void* chunk = heap.acquireChunk();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(chunk) % MPointerHeap::CHUNK_SIZE, 0u);
+    static_cast<char*>(chunk)[0] = 1;  // Tocar el chunk para que tenga páginas residentes
+
+    size_t returnedBefore = heap.getReturnedBytes();
+    heap.releaseChunk(chunk);
+    EXPECT_GE(heap.getReturnedBytes(), returnedBefore + MPointerHeap::CHUNK_SIZE);
+
+    // Un chunk devuelto se puede reutilizar normalmente
+    void* again = heap.acquireChunk();
+    static_cast<char*>(again)[0] = 2;
+    heap.releaseChunk(again);
+
+    heap.setIdlePeriod(std::chrono::milliseconds(1000));
+    heap.setHugePages(false);
+}
+
+//El slab reparte slots alineados y suelta el chunk cuando queda vacío
+TEST(MPointerHeapTest, SlabReleasesEmptyChunks) {
+    MPointerSlab slab(24, 8);
+    std::vector<void*> slots;
+    for (size_t i = 0; i < slab.getSlotsPerChunk() + 1; i++) {
+        slots.push_back(slab.allocate());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(slots.back()) % 8, 0u);
+    }
+    EXPECT_EQ(slab.getChunkCount(), 2u);  // El último objeto no cabe en el primer chunk
+
+    for (void* slot : slots) {
+        slab.deallocate(slot);
+    }
+    EXPECT_EQ(slab.getChunkCount(), 0u);
+    EXPECT_EQ(slab.getLiveObjects(), 0u);
+}
+
+//Los objetos del GC salen de chunks del MPointerHeap
+TEST(MPointerHeapTest, GarbageCollectorUsesSlab) {
+    auto ptr = MPointer<RecycledNode>::New();
+    ptr->value = 3;
+    EXPECT_GE(MPointerGC<RecycledNode>::getInstance()->getSlabChunks(), 1u);
+    EXPECT_GT(MPointerHeap::getInstance().getResidentBytes(), 0u);
+    EXPECT_GT(MPointerHeap::getProcessResidentBytes(), 0u);
+}
+
+// Tipo auxiliar con su propio GC para las pruebas de compactación
+struct CompactedNode {
+    int value = 0;
+};
+
+//La compactación mueve los objetos a chunks densos y los MPointers siguen funcionando por ID
+TEST(GarbageCollectorTest, CompactionRelocatesLiveObjects) {
+    MPointerGC<CompactedNode>* gc = MPointerGC<CompactedNode>::getInstance();
+
+    std::vector<MPointer<CompactedNode>> all;
+    for (int i = 0; i < 200; i++) {
+        all.push_back(MPointer<CompactedNode>::New());
+        all.back()->value = i;
+    }
+    std::vector<MPointer<CompactedNode>> live;
+    for (int i = 0; i < 200; i++) {
+        if (i % 4 == 0) {
+            live.push_back(all[i]);
+        } else {
+            int id = all[i].getId();
+            all[i] = nullptr;
+            gc->FreeMemory(id);  // Deja huecos en el slab
+        }
+    }
+    all.clear();
+    EXPECT_GT(gc->getFragmentation(), 0.5);
+
+    CompactedNode* before = live[1].get();
+    EXPECT_EQ(gc->compact(), live.size());
+
+    EXPECT_NE(live[1].get(), before);  // El objeto cambió de dirección
+    EXPECT_EQ(gc->getAddress(live[1].getId()), live[1].get());
+    for (size_t i = 0; i < live.size(); i++) {
+        EXPECT_EQ(live[i]->value, static_cast<int>(i * 4));
+    }
+    EXPECT_LT(gc->getFragmentation(), 0.01);
+}
+
+//Una lista doblemente enlazada sigue intacta después de compactar sus nodos en orden de recorrido
+TEST(GarbageCollectorTest, CompactionKeepsListLinks) {
+    DoublyLinkedList<int> list;
+    for (int value : {4, 2, 8, 6}) {
+        list.append(value);
+    }
+    MPointerGC<Node<int>>::getInstance()->compact();
+    quickSort(list);
+
+    EXPECT_EQ(list.size(), 4);
+    EXPECT_EQ(list.get(0), 2);
+    EXPECT_EQ(list.get(3), 8);
+}
+
+//NewBlock crea objetos independientes uno junto al otro en memoria
+TEST(GarbageCollectorTest, NewBlockIsContiguous) {
+    auto block = MPointer<CompactedNode>::NewBlock(10);
+    ASSERT_EQ(block.size(), 10u);
+    for (size_t i = 1; i < block.size(); i++) {
+        EXPECT_EQ(reinterpret_cast<char*>(block[i].get()) - reinterpret_cast<char*>(block[i - 1].get()),
+                  reinterpret_cast<char*>(block[1].get()) - reinterpret_cast<char*>(block[0].get()));
+        EXPECT_NE(block[i].getId(), block[i - 1].getId());
+    }
+}
+
+//relayout conserva el orden y los enlaces de la lista
+TEST(DoublyLinkedListTest, RelayoutKeepsOrder) {
+    DoublyLinkedList<int> list;
+    for (int value : {3, 1, 2, 5, 4}) {
+        list.append(value);
+    }
+    list.relayout();
+
+    ASSERT_EQ(list.size(), 5);
+    EXPECT_EQ(list.get(0), 3);
+    EXPECT_EQ(list.get(4), 4);
+
+    bubbleSort(list);  // Las operaciones normales siguen funcionando sobre los nodos nuevos
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(list.get(i), i + 1);
+    }
+}
+
+// Tipo auxiliar con su propio GC para el modo generacional
+struct GenerationalNode {
+    int value = 0;
+};
+
+//En modo generacional los objetos jóvenes sin referencias se liberan en un pase menor
+TEST(GarbageCollectorTest, GenerationalMinorCollectionFreesYoungGarbage) {
+    MPointerGC<GenerationalNode>* gc = MPointerGC<GenerationalNode>::getInstance();
+    gc->setGenerational(true);
+    gc->setPromotionAge(3);
+    gc->setMajorCollectionInterval(1000);
+
+    auto kept = MPointer<GenerationalNode>::New();
+    int garbageId;
+    {
+        auto dropped = MPointer<GenerationalNode>::New();
+        garbageId = dropped.getId();
+    }
+    EXPECT_EQ(gc->getNurserySize(), 2u);
+
+    CollectionStats stats = gc->collect(false);  // El mismo ciclo que haría el hilo: solo la nursery
+    EXPECT_FALSE(stats.major);
+
+    EXPECT_EQ(gc->getAddress(garbageId), nullptr);  // Liberado sin pase mayor
+    EXPECT_NE(gc->getAddress(kept.getId()), nullptr);
+    EXPECT_GE(gc->getMinorCollections(), 1u);
+    EXPECT_EQ(gc->getMajorCollections(), 0u);
+    gc->setGenerational(false);
+}
+
+// Tipo auxiliar con su propio GC para la recolección incremental
+struct IncrementalNode {
+    int value = 0;
+};
+
+//Con presupuesto por objetos el barrido se hace en varias rebanadas y aun así libera toda la basura
+TEST(GarbageCollectorTest, IncrementalSweepUsesSlices) {
+    MPointerGC<IncrementalNode>* gc = MPointerGC<IncrementalNode>::getInstance();
+    gc->setIncrementalBudget(std::chrono::microseconds(100), 10);
+
+    std::vector<int> ids;
+    {
+        std::vector<MPointer<IncrementalNode>> ptrs;
+        for (int i = 0; i < 100; i++) {
+            ptrs.push_back(MPointer<IncrementalNode>::New());
+            ids.push_back(ptrs.back().getId());
+        }
+    }
+
+    gc->collect();
+
+    for (int id : ids) {
+        EXPECT_EQ(gc->getAddress(id), nullptr);
+    }
+    size_t slices = 0;
+    for (size_t count : gc->getPauseHistogram()) {
+        slices += count;
+    }
+    EXPECT_GE(slices, 10u);  // 100 objetos / 10 por rebanada
+    gc->setIncrementalBudget(std::chrono::microseconds(0), 0);
+}
+
+// Tipo auxiliar con su propio GC para el barrido en paralelo
+struct ParallelNode {
+    int value = 0;
+};
+
+//parallelFor ejecuta cada tarea exactamente una vez
+TEST(MPointerWorkerPoolTest, ParallelForRunsEveryTask) {
+    MPointerWorkerPool pool(4);
+    std::vector<std::atomic<int>> runs(100);
+    for (int round = 0; round < 3; round++) {
+        pool.parallelFor(runs.size(), [&runs](size_t index) { runs[index]++; });
+    }
+    for (auto& count : runs) {
+        EXPECT_EQ(count.load(), 3);
+    }
+}
+
+//Con varios workers el barrido en paralelo libera toda la basura
+// (el lote alcanza para repartirlo: más de PARALLEL_DISPOSE_MIN objetos por worker)
+TEST(GarbageCollectorTest, ParallelSweepFreesGarbage) {
+    MPointerGC<ParallelNode>* gc = MPointerGC<ParallelNode>::getInstance();
+    gc->setSweepWorkers(4);
+
+    std::vector<int> ids;
+    auto kept = MPointer<ParallelNode>::New();
+    {
+        std::vector<MPointer<ParallelNode>> ptrs;
+        for (int i = 0; i < 20000; i++) {
+            ptrs.push_back(MPointer<ParallelNode>::New());
+            ids.push_back(ptrs.back().getId());
+        }
+    }
+
+    gc->collect();
+
+    for (int id : ids) {
+        EXPECT_EQ(gc->getAddress(id), nullptr);
+    }
+    EXPECT_NE(gc->getAddress(kept.getId()), nullptr);
+    gc->setSweepWorkers(1);
+}
+
+// Tipo auxiliar con su propio GC para el conteo diferido
+struct DeferredNode {
+    int value = 0;
+};
+
+//Con conteo diferido las copias no tocan el refCount hasta el siguiente ciclo y el objeto sigue vivo
+TEST(GarbageCollectorTest, DeferredRefCountingAppliesLogsOnCollection) {
+    MPointerGC<DeferredNode>* gc = MPointerGC<DeferredNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);  // Sin hilo del GC que aplique los logs antes de tiempo
+    gc->setDeferredRefCounting(true);
+
+    auto shared = MPointer<DeferredNode>::New();
+    int id = shared.getId();
+    std::vector<std::thread> threads;
+    std::vector<MPointer<DeferredNode>> copies(4);
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&copies, &shared, i]() {
+            for (int j = 0; j < 1000; j++) {
+                MPointer<DeferredNode> temporary = shared;  // +1 / -1 en el log del hilo
+            }
+            copies[i] = shared;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(gc->getRefCount(id), 1);  // Todavía nada aplicado
+
+    gc->collect();  // Aplica los incrementos y también los decrementos retenidos
+    EXPECT_EQ(gc->getRefCount(id), 5);  // shared + 4 copias
+
+    copies.clear();
+    shared = nullptr;
+    gc->collect();
+    EXPECT_EQ(gc->getAddress(id), nullptr);  // Liberado cuando los decrementos llegaron
+    gc->setDeferredRefCounting(false);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar para la contrapresión del log diferido
+struct DeferredBackPressureNode {
+    int value = 0;
+};
+
+//Sin GC que recoja los logs (modo manual), el hilo que llena el suyo hasta el doble del umbral lo aplica
+TEST(GarbageCollectorTest, DeferredRefCountingLogHasBackPressure) {
+    MPointerGC<DeferredBackPressureNode>* gc = MPointerGC<DeferredBackPressureNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    gc->setDeferredRefCounting(true);
+
+    auto first = MPointer<DeferredBackPressureNode>::New();
+    auto second = MPointer<DeferredBackPressureNode>::New();
+    std::vector<MPointer<DeferredBackPressureNode>> copies;
+    copies.reserve(1 << 17);
+    for (int i = 0; i < (1 << 16); i++) {
+        copies.push_back(first);   // Los IDs se alternan: ninguna entrada se junta con la anterior
+        copies.push_back(second);
+    }
+    EXPECT_GT(gc->getRefCount(first.getId()), 1);  // Se aplicó sin llamar a collect()
+
+    int id = first.getId();
+    copies.clear();
+    first = nullptr;
+    second = nullptr;
+    gc->collect();
+    gc->collect();
+    EXPECT_EQ(gc->getAddress(id), nullptr);
+    gc->setDeferredRefCounting(false);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar para el conteo sesgado
+struct BiasedNode {
+    int value = 0;
+};
+
+//Con conteo sesgado el hilo dueño cuenta sin atómicos; si otro hilo suelta la última copia se hace el merge
+TEST(GarbageCollectorTest, BiasedRefCountingMergesForeignRelease) {
+    MPointerGC<BiasedNode>* gc = MPointerGC<BiasedNode>::getInstance();
+    gc->setRefCountMode(RefCountMode::Biased);
+
+    auto owned = MPointer<BiasedNode>::New();
+    int id = owned.getId();
+    MPointer<BiasedNode> handed = owned;  // Copia del dueño: solo toca el contador sesgado
+    EXPECT_EQ(gc->getRefCount(id), 2);
+
+    std::thread foreign([moved = handed]() mutable {
+        MPointer<BiasedNode> temporary = moved;  // Hilo ajeno: contador atómico
+        moved = nullptr;
+    });
+    handed = nullptr;
+    foreign.join();  // El contador compartido quedó en -1: merge pendiente para el dueño
+    EXPECT_EQ(gc->getRefCount(id), 1);
+
+    gc->collect();
+    EXPECT_NE(gc->getAddress(id), nullptr);  // Con un merge pendiente el nodo no es basura
+
+    owned = nullptr;  // El dueño suelta su última referencia; el merge pendiente lo hace el GC
+    gc->collect();
+    EXPECT_EQ(gc->getAddress(id), nullptr);
+    gc->setRefCountMode(RefCountMode::Locked);
+}
+
+struct BiasedIdleOwnerNode {
+    int value = 0;
+};
+
+//Si el dueño sigue vivo pero no vuelve a usar el nodo, el merge lo hace el GC
+TEST(GarbageCollectorTest, BiasedRefCountingCollectorMergesForIdleOwner) {
+    MPointerGC<BiasedIdleOwnerNode>* gc = MPointerGC<BiasedIdleOwnerNode>::getInstance();
+    gc->setRefCountMode(RefCountMode::Biased);
+    gc->setCollectionMode(CollectionMode::Manual);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done = false;
+    MPointer<BiasedIdleOwnerNode> handed;
+    std::thread owner([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        handed = MPointer<BiasedIdleOwnerNode>::New();
+        changed.notify_all();
+        changed.wait(lock, [&done]() { return done; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&handed]() { return handed != nullptr; });
+    }
+    int id = handed.getId();
+    handed = nullptr;  // Hilo ajeno: el contador compartido queda en -1 y el merge en la cola del dueño
+    EXPECT_NE(gc->getAddress(id), nullptr);
+
+    gc->collect();
+    EXPECT_EQ(gc->getAddress(id), nullptr);  // Liberado con el dueño todavía vivo
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    changed.notify_all();
+    owner.join();
+    gc->setCollectionMode(CollectionMode::Background);
+    gc->setRefCountMode(RefCountMode::Locked);
+}
+
+struct BiasedImmediateNode {
+    int value = 0;
+};
+
+//En modo inmediato el merge que deja el total en 0 libera el objeto: no hay hilo del GC que lo encuentre
+TEST(GarbageCollectorTest, BiasedRefCountingImmediateModeFreesAfterMerge) {
+    MPointerGC<BiasedImmediateNode>* gc = MPointerGC<BiasedImmediateNode>::getInstance();
+    gc->setRefCountMode(RefCountMode::Biased);
+    gc->setCollectionMode(CollectionMode::Immediate);
+
+    // El dueño termina antes: el hilo que suelta la última copia hace el merge
+    MPointer<BiasedImmediateNode> handed;
+    std::thread owner([&handed]() {
+        handed = MPointer<BiasedImmediateNode>::New();
+    });
+    owner.join();
+    int orphanId = handed.getId();
+    std::thread foreign([&handed]() {
+        handed = nullptr;
+    });
+    foreign.join();
+    EXPECT_EQ(gc->getAddress(orphanId), nullptr);
+
+    // El dueño sigue vivo cuando otro hilo suelta la última copia: el merge queda en su cola y lo hace al terminar
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done = false;
+    int queuedId = 0;
+    std::thread longLived([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        handed = MPointer<BiasedImmediateNode>::New();
+        queuedId = handed.getId();
+        changed.notify_all();
+        changed.wait(lock, [&done]() { return done; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&queuedId]() { return queuedId != 0; });
+    }
+    std::thread dropper([&handed]() {
+        handed = nullptr;
+    });
+    dropper.join();
+    EXPECT_NE(gc->getAddress(queuedId), nullptr);  // Merge pendiente en la cola del dueño
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    changed.notify_all();
+    longLived.join();
+    EXPECT_EQ(gc->getAddress(queuedId), nullptr);
+
+    gc->setCollectionMode(CollectionMode::Background);
+    gc->setRefCountMode(RefCountMode::Locked);
+}
+
+struct ConcurrentReleaseNode {
+    static inline std::atomic<int> destroyed{0};
+    ~ConcurrentReleaseNode() {
+        destroyed.fetch_add(1);
+    }
+};
+
+//Varios hilos sueltan a la vez las copias de muchos objetos: cada uno se destruye una sola vez y nadie toca el
+//nodo después de su último decremento (con ASan, un acceso tardío es un heap-use-after-free)
+TEST(GarbageCollectorTest, ImmediateModeConcurrentReleaseFreesOnce) {
+    MPointerGC<ConcurrentReleaseNode>* gc = MPointerGC<ConcurrentReleaseNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Immediate);
+    for (RefCountMode mode : {RefCountMode::Atomic, RefCountMode::Biased}) {
+        gc->setRefCountMode(mode);
+        ConcurrentReleaseNode::destroyed = 0;
+        constexpr int OBJECTS = 2000;
+        constexpr int THREADS = 4;
+        std::vector<std::vector<MPointer<ConcurrentReleaseNode>>> copies(THREADS);
+        for (int i = 0; i < OBJECTS; i++) {
+            auto object = MPointer<ConcurrentReleaseNode>::New();
+            for (auto& mine : copies) {
+                mine.push_back(object);
+            }
+        }
+        std::vector<std::thread> threads;
+        for (auto& mine : copies) {
+            threads.emplace_back([&mine]() {
+                mine.clear();
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (mode == RefCountMode::Biased) {
+            gc->collect();  // Este hilo es el dueño y no vuelve a usar los nodos: los merges los hace el GC
+        }
+        EXPECT_EQ(ConcurrentReleaseNode::destroyed.load(), OBJECTS);
+    }
+    gc->setCollectionMode(CollectionMode::Background);
+    gc->setRefCountMode(RefCountMode::Locked);
+}
+
+// Tipos auxiliares para los disparadores de la recolección
+struct TriggeredNode {
+    char payload[64] = {};
+};
+
+struct PendingNode {
+    int value = 0;
+};
+
+//Al cruzar el umbral de bytes reservados el GC corre sin esperar el temporizador
+TEST(GarbageCollectorTest, AllocationVolumeTriggersCollection) {
+    MPointerGC<TriggeredNode>* gc = MPointerGC<TriggeredNode>::getInstance();
+    CollectionTriggers triggers;
+    triggers.bytesAllocated = 1000 * sizeof(TriggeredNode);
+    triggers.maxLatency = std::chrono::milliseconds(60000);
+    gc->setCollectionTriggers(triggers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // El hilo toma los umbrales nuevos
+
+    size_t before = gc->getCollectionCount();
+    for (int i = 0; i < 999; i++) {
+        MPointer<TriggeredNode>::New();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(gc->getCollectionCount(), before);  // Por debajo del umbral no despierta
+
+    MPointer<TriggeredNode>::New();
+    for (int i = 0; i < 100 && gc->getCollectionCount() == before; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(gc->getCollectionCount(), before);
+    EXPECT_LT(gc->getBytesSinceCollection(), triggers.bytesAllocated);
+    gc->setCollectionTriggers(CollectionTriggers());
+}
+
+//Con el umbral de objetos pendientes el GC despierta cuando suficientes refCounts llegan a 0
+TEST(GarbageCollectorTest, PendingZeroCountTriggersCollection) {
+    MPointerGC<PendingNode>* gc = MPointerGC<PendingNode>::getInstance();
+    CollectionTriggers triggers;
+    triggers.pendingZeroCount = 50;
+    triggers.maxLatency = std::chrono::milliseconds(0);  // Sin temporizador
+    gc->setCollectionTriggers(triggers);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<MPointer<PendingNode>> objects;
+    std::vector<int> ids;
+    for (int i = 0; i < 50; i++) {
+        objects.push_back(MPointer<PendingNode>::New());
+        ids.push_back(objects.back().getId());
+    }
+    objects.clear();
+    for (int i = 0; i < 100 && gc->getAddress(ids.back()) != nullptr; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(gc->getAddress(ids.front()), nullptr);
+    EXPECT_EQ(gc->getAddress(ids.back()), nullptr);
+    gc->setCollectionTriggers(CollectionTriggers());
+}
+
+// Tipo auxiliar para el modo manual
+struct ManualNode {
+    int value = 0;
+};
+
+//collect() devuelve lo que liberó y en modo manual no hay ciclos sin una llamada explícita
+TEST(GarbageCollectorTest, ManualModeCollectsOnlyOnRequest) {
+    MPointerGC<ManualNode>* gc = MPointerGC<ManualNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    size_t collectionsBefore = gc->getCollectionCount();
+
+    auto kept = MPointer<ManualNode>::New();
+    std::vector<int> ids;
+    for (int i = 0; i < 10; i++) {
+        ids.push_back(MPointer<ManualNode>::New().getId());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));  // Más que el temporizador del hilo
+    EXPECT_EQ(gc->getCollectionCount(), collectionsBefore);
+    EXPECT_NE(gc->getAddress(ids.front()), nullptr);
+
+    CollectionStats stats = gc->collect();
+    EXPECT_EQ(stats.freed, 10u);
+    EXPECT_EQ(stats.bytesFreed, 10 * sizeof(ManualNode));
+    EXPECT_EQ(stats.remaining, 1u);
+    EXPECT_TRUE(stats.major);
+    EXPECT_EQ(gc->getAddress(ids.back()), nullptr);
+
+    // Un umbral cruzado recolecta en el hilo que lo cruza
+    CollectionTriggers triggers;
+    triggers.pendingZeroCount = 5;
+    gc->setCollectionTriggers(triggers);
+    for (int i = 0; i < 5; i++) {
+        MPointer<ManualNode>::New();
+    }
+    EXPECT_EQ(gc->getCollectionCount(), collectionsBefore + 2);
+
+    gc->setCollectionTriggers(CollectionTriggers());
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar para las estadísticas
+struct StatsNode {
+    int value = 0;
+};
+
+//stats() refleja reservas, liberaciones, objetos vivos y ciclos sin tomar locks
+TEST(GarbageCollectorTest, StatsTrackAllocationsAndFrees) {
+    MPointerGC<StatsNode>* gc = MPointerGC<StatsNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    MPointerGCStats before = gc->stats();
+
+    std::vector<MPointer<StatsNode>> kept;
+    for (int i = 0; i < 30; i++) {
+        auto ptr = MPointer<StatsNode>::New();
+        if (i % 3 == 0) {
+            kept.push_back(ptr);
+        }
+    }
+    MPointerGCStats allocated = gc->stats();
+    EXPECT_EQ(allocated.allocations - before.allocations, 30u);
+    EXPECT_EQ(allocated.liveObjects - before.liveObjects, 30u);
+
+    gc->collect();
+    MPointerGCStats after = gc->stats();
+    EXPECT_EQ(after.frees - before.frees, 20u);
+    EXPECT_EQ(after.liveObjects, kept.size());
+    EXPECT_EQ(after.liveBytes, kept.size() * sizeof(StatsNode));
+    EXPECT_EQ(after.collections, before.collections + 1);
+    EXPECT_EQ(after.pauseHistogram.size(), 32u);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar para los histogramas de vida
+struct LifetimeNode {
+    int value = 0;
+};
+
+//Los objetos liberados quedan en los histogramas según los ciclos que sobrevivieron y cuánto vivieron
+TEST(GarbageCollectorTest, LifetimeHistogramsCountSurvivedCycles) {
+    MPointerGC<LifetimeNode>* gc = MPointerGC<LifetimeNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    gc->setLifetimeTiming(true);
+    gc->collect();
+    MPointerGCStats before = gc->stats();
+
+    MPointer<LifetimeNode>::New();  // Basura del primer ciclo: sobrevive 0 ciclos
+    {
+        MPointer<LifetimeNode> survivor = MPointer<LifetimeNode>::New();
+        gc->collect();
+        gc->collect();
+        gc->collect();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    gc->collect();  // El sobreviviente se libera después de 3 ciclos
+
+    MPointerGCStats after = gc->stats();
+    ASSERT_EQ(after.survivedHistogram.size(), after.lifetimeHistogram.size());
+    EXPECT_EQ(after.survivedHistogram[0] - before.survivedHistogram[0], 1u);  // 0 ciclos
+    EXPECT_EQ(after.survivedHistogram[2] - before.survivedHistogram[2], 1u);  // 2-3 ciclos
+    size_t freed = 0;
+    size_t longLived = 0;
+    for (size_t k = 0; k < after.lifetimeHistogram.size(); k++) {
+        freed += after.lifetimeHistogram[k] - before.lifetimeHistogram[k];
+        if (k >= 11) {  // 2^10 us o más
+            longLived += after.lifetimeHistogram[k] - before.lifetimeHistogram[k];
+        }
+    }
+    EXPECT_EQ(freed, 2u);
+    EXPECT_EQ(longLived, 1u);
+    EXPECT_EQ(gc->getSurvivedHistogram(), after.survivedHistogram);
+
+    gc->setLifetimeTiming(false);  // Sin medición de tiempo solo se cuentan los ciclos
+    MPointer<LifetimeNode>::New();
+    gc->collect();
+    MPointerGCStats untimed = gc->stats();
+    EXPECT_EQ(untimed.survivedHistogram[0] - after.survivedHistogram[0], 1u);
+    EXPECT_EQ(untimed.lifetimeHistogram, after.lifetimeHistogram);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar que cuenta sus destrucciones
+struct WalkedNode {
+    static inline std::atomic<int> destroyed{0};
+    int value = 0;
+    ~WalkedNode() { destroyed++; }
+};
+
+//forEachLive recorre los objetos vivos sin bloquear al GC y posterga las destrucciones hasta terminar
+TEST(GarbageCollectorTest, ForEachLiveVisitsSnapshotAndDefersFrees) {
+    MPointerGC<WalkedNode>* gc = MPointerGC<WalkedNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    gc->collect();
+
+    std::vector<MPointer<WalkedNode>> objects;
+    std::set<int> ids;
+    for (int i = 0; i < 10; i++) {
+        objects.push_back(MPointer<WalkedNode>::New());
+        objects.back()->value = i;
+        ids.insert(objects.back().getId());
+    }
+    MPointer<WalkedNode> shared = objects[0];
+
+    std::set<int> visited;
+    int destroyedBefore = WalkedNode::destroyed.load();
+    size_t count = gc->forEachLive([&](const MPointerLiveObject<WalkedNode>& object) {
+        visited.insert(object.id);
+        EXPECT_EQ(object.refCount, object.id == shared.getId() ? 2 : 1);
+        EXPECT_EQ(object.size, sizeof(WalkedNode));
+        EXPECT_NE(object.address, nullptr);
+        if (visited.size() == 1) {
+            objects.clear();  // Se sueltan las referencias y se recolecta durante el recorrido
+            gc->collect();
+            EXPECT_EQ(WalkedNode::destroyed.load(), destroyedBefore);  // Postergado
+        }
+    });
+    EXPECT_EQ(count, ids.size());
+    EXPECT_EQ(visited, ids);
+    EXPECT_EQ(WalkedNode::destroyed.load(), destroyedBefore + 9);  // Al terminar el recorrido
+
+    EXPECT_EQ(gc->forEachLive([](const MPointerLiveObject<WalkedNode>&) {}), 1u);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+// Tipo auxiliar encadenado para el modo inmediato
+struct ChainNode {
+    MPointer<ChainNode> next;
+    int value = 0;
+};
+
+//En modo inmediato soltar la última referencia destruye el objeto en el acto, sin recursión por la cadena
+TEST(GarbageCollectorTest, ImmediateModeFreesOnLastRelease) {
+    MPointerGC<ChainNode>* gc = MPointerGC<ChainNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Immediate);
+
+    auto head = MPointer<ChainNode>::New();
+    int headId = head.getId();
+    std::vector<int> ids;
+    MPointer<ChainNode> tail = head;
+    for (int i = 0; i < 10000; i++) {
+        MPointer<ChainNode> node = MPointer<ChainNode>::New();
+        tail->next = node;
+        tail = node;
+        ids.push_back(node.getId());
+    }
+    tail = nullptr;
+
+    auto copy = head;
+    head = nullptr;
+    EXPECT_NE(gc->getAddress(headId), nullptr);  // Todavía queda la copia
+
+    copy = nullptr;  // Última referencia: se libera la cadena completa en este hilo
+    EXPECT_EQ(gc->getAddress(headId), nullptr);
+    EXPECT_EQ(gc->getAddress(ids.front()), nullptr);
+    EXPECT_EQ(gc->getAddress(ids.back()), nullptr);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+//Asignar un MPointer que vive dentro del objeto que se suelta (p = p->next) no lee memoria liberada
+TEST(GarbageCollectorTest, ImmediateModeAssignFromInsideReleasedObject) {
+    MPointerGC<ChainNode>* gc = MPointerGC<ChainNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Immediate);
+
+    auto p = MPointer<ChainNode>::New();
+    int firstId = p.getId();
+    p->value = 1;
+    p->next = MPointer<ChainNode>::New();
+    p->next->value = 2;
+    int secondId = p->next.getId();
+
+    p = p->next;  // `p` era la única referencia al primero
+    EXPECT_EQ(gc->getAddress(firstId), nullptr);
+    EXPECT_NE(gc->getAddress(secondId), nullptr);
+    EXPECT_EQ(p.getId(), secondId);
+    EXPECT_EQ(p->value, 2);
+    p = nullptr;
+    EXPECT_EQ(gc->getAddress(secondId), nullptr);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+///////////////////////////////////////////////////////MPointerPolicy///////////////////////////////////////////////////
+// Tipo auxiliar que cuenta sus destrucciones para las políticas con conteo directo
+struct PolicyCounted {
+    static inline std::atomic<int> destroyed{0};
+    int value = 0;
+    ~PolicyCounted() { ++destroyed; }
+};
+
+//La política de un solo hilo es un puntero más un contador normal y destruye en la última liberación
+TEST(MPointerPolicyTest, SingleThreadedPolicyIsPointerAndCounter) {
+    using Ptr = MPointer<PolicyCounted, MPointerSingleThreadedPolicy>;
+    static_assert(sizeof(Ptr) == 2 * sizeof(void*), "puntero + bloque con el contador");
+    static_assert(std::is_same_v<MPointerCountedBlock<PolicyCounted, MPointerSingleThreadedPolicy>::Counter, long>);
+
+    PolicyCounted::destroyed = 0;
+    Ptr first = Ptr::New();
+    first->value = 7;
+    {
+        Ptr second = first;
+        Ptr third;
+        third = second;
+        EXPECT_EQ(third->value, 7);
+        EXPECT_EQ(third.getId(), 0);  // Sin registro en el GC
+    }
+    EXPECT_EQ(PolicyCounted::destroyed.load(), 0);
+    first = nullptr;
+    EXPECT_EQ(PolicyCounted::destroyed.load(), 1);
+}
+
+//Con la política atómica varios hilos pueden copiar el mismo MPointer
+TEST(MPointerPolicyTest, AtomicPolicyCountsAcrossThreads) {
+    using Ptr = MPointer<PolicyCounted, MPointerAtomicPolicy>;
+    PolicyCounted::destroyed = 0;
+    Ptr shared = Ptr::New();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&shared]() {
+            for (int j = 0; j < 10000; j++) {
+                Ptr copy = shared;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(PolicyCounted::destroyed.load(), 0);
+    shared = nullptr;
+    EXPECT_EQ(PolicyCounted::destroyed.load(), 1);
+}
+
+// Nodo encadenado con conteo directo: soltar la última referencia lo destruye en el acto
+template <typename Policy>
+struct PolicyChainNode {
+    MPointer<PolicyChainNode, Policy> next;
+    int value = 0;
+};
+
+// p = p->next siendo `p` el único dueño: la referencia nueva se toma antes de destruir el bloque viejo
+template <typename Policy>
+void expectAssignFromInsideReleasedBlock() {
+    using Ptr = MPointer<PolicyChainNode<Policy>, Policy>;
+    Ptr p = Ptr::New();
+    p->value = 1;
+    p->next = Ptr::New();
+    p->next->value = 2;
+    p = p->next;
+    EXPECT_EQ(p->value, 2);
+    EXPECT_TRUE(p->next == nullptr);
+}
+
+TEST(MPointerPolicyTest, SingleThreadedPolicyAssignFromInsideReleasedBlock) {
+    expectAssignFromInsideReleasedBlock<MPointerSingleThreadedPolicy>();
+}
+
+TEST(MPointerPolicyTest, AtomicPolicyAssignFromInsideReleasedBlock) {
+    expectAssignFromInsideReleasedBlock<MPointerAtomicPolicy>();
+}
+
+//La política de región exige un MPointerScope activo
+TEST(MPointerPolicyTest, RegionPolicyRequiresScope) {
+    using Ptr = MPointer<int, MPointerRegionPolicy>;
+    static_assert(sizeof(Ptr) <= 2 * sizeof(void*));
+    EXPECT_THROW(Ptr::New(), std::logic_error);
+    MPointerScope scope;
+    Ptr ptr = Ptr::New();
+    *ptr = 3;
+    EXPECT_EQ(*ptr, 3);
+    EXPECT_GE(scope.getBytesUsed(), sizeof(int));
+}
+
+///////////////////////////////////////////////////////MPointerTrace////////////////////////////////////////////////////
+// Tipo auxiliar con su propio GC para el tracer
+struct TracedNode {
+    int value = 0;
+};
+
+//Con el tracer activo quedan los eventos de New, registro, refCount en 0, barrido y liberación
+TEST(MPointerTraceTest, RecordsLifecycleEvents) {
+    MPointerGC<TracedNode>* gc = MPointerGC<TracedNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    std::vector<MPointerTraceEvent> events;
+    MPointerTrace::drain(events);  // Descarta lo anterior
+    events.clear();
+
+    MPointerTrace::setEnabled(true);
+    int id = MPointer<TracedNode>::New().getId();
+    gc->collect();
+    MPointerTrace::setEnabled(false);
+    MPointer<TracedNode>::New();  // Apagado: no deja eventos
+
+    MPointerTrace::drain(events);
+    uint16_t thread = 0;  // Solo cuentan los eventos de este hilo (los GC de otros tipos siguen corriendo)
+    for (auto& event : events) {
+        if (event.kind == MPointerTraceKind::Register && event.id == id) {
+            thread = event.thread;
+        }
+    }
+    std::vector<MPointerTraceKind> kinds;
+    for (auto& event : events) {
+        if (event.thread == thread) {
+            kinds.push_back(event.kind);
+        }
+    }
+    std::vector<MPointerTraceKind> expected = {MPointerTraceKind::New, MPointerTraceKind::Register,
+                                               MPointerTraceKind::RefCountZero, MPointerTraceKind::SweepStart,
+                                               MPointerTraceKind::SliceStart, MPointerTraceKind::Free,
+                                               MPointerTraceKind::SliceEnd, MPointerTraceKind::SweepEnd};
+    EXPECT_EQ(kinds, expected);
+    for (size_t i = 1; i < events.size(); i++) {
+        if (events[i].thread == thread && events[i - 1].thread == thread) {
+            EXPECT_GE(events[i].timestamp, events[i - 1].timestamp);  // Dentro de un hilo: en orden
+        }
+    }
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+//Si el ring de un hilo se llena los eventos nuevos se descartan y se cuentan
+TEST(MPointerTraceTest, FullRingDropsEvents) {
+    std::vector<MPointerTraceEvent> events;
+    MPointerTrace::drain(events);
+    uint64_t droppedBefore = MPointerTrace::getDropped();
+    MPointerTrace::setEnabled(true);
+    for (size_t i = 0; i < MPointerTrace::RING_SIZE + 10; i++) {
+        MPointerTrace::trace(MPointerTraceKind::New, 0, i);
+    }
+    MPointerTrace::setEnabled(false);
+    events.clear();
+    EXPECT_EQ(MPointerTrace::drain(events), MPointerTrace::RING_SIZE);
+    EXPECT_EQ(MPointerTrace::getDropped() - droppedBefore, 10u);
+}
+
+//El exportador escribe un JSON de Chrome trace con el ciclo de recolección como evento de duración
+TEST(MPointerTraceTest, ChromeTraceExportsCollection) {
+    MPointerGC<TracedNode>* gc = MPointerGC<TracedNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    std::string path = testing::TempDir() + "mpointer_chrome_trace.json";
+    {
+        MPointerChromeTrace chromeTrace(path, std::chrono::milliseconds(5));
+        MPointer<TracedNode>::New();
+        gc->collect();
+    }
+    EXPECT_FALSE(MPointerTrace::enabled());
+
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string json = content.str();
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"name\":\"collection\",\"cat\":\"mpointer\",\"ph\":\"B\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"collection\",\"cat\":\"mpointer\",\"ph\":\"E\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"free\""), std::string::npos);
+    EXPECT_NE(json.find("]}"), std::string::npos);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+///////////////////////////////////////////////////////MPointerRuntime//////////////////////////////////////////////////
+// Tipo auxiliar grande para llegar rápido al límite del heap
+struct LimitedNode {
+    char payload[1024] = {};
+};
+
+//Si New() superaría el límite, la recolección de emergencia libera la basura pendiente y la reserva sigue
+TEST(MPointerRuntimeTest, EmergencyCollectionMakesRoom) {
+    MPointerRuntime& runtime = MPointerRuntime::getInstance();
+    MPointerGC<LimitedNode>::getInstance();  // El GC del tipo queda registrado antes de fijar el límite
+    size_t emergenciesBefore = runtime.getEmergencyCollections();
+    runtime.setHeapLimit(runtime.getLiveBytes() + 50 * sizeof(LimitedNode));
+
+    EXPECT_NO_THROW({
+        for (int i = 0; i < 500; i++) {
+            MPointer<LimitedNode>::New();  // Basura inmediata
+        }
+    });
+    EXPECT_GT(runtime.getEmergencyCollections(), emergenciesBefore);
+    EXPECT_GT(runtime.getThrottledAllocations(), 0u);
+    EXPECT_LE(runtime.getLiveBytes(), runtime.getHeapLimit());
+    runtime.setHeapLimit(0);
+}
+
+//Con todos los objetos vivos la reserva falla con MPointerHeapLimitExceeded
+TEST(MPointerRuntimeTest, LimitThrowsWhenEverythingIsLive) {
+    MPointerRuntime& runtime = MPointerRuntime::getInstance();
+    std::vector<MPointer<LimitedNode>> live;
+    runtime.collectAll();  // La basura que dejaron otras pruebas no cuenta para el límite
+    runtime.setHeapLimit(runtime.getLiveBytes() + 20 * sizeof(LimitedNode));
+    for (int i = 0; i < 20; i++) {
+        live.push_back(MPointer<LimitedNode>::New());
+    }
+    size_t failedBefore = runtime.getFailedAllocations();
+    EXPECT_THROW(MPointer<LimitedNode>::New(), MPointerHeapLimitExceeded);
+    EXPECT_THROW(MPointer<LimitedNode>::New(), std::bad_alloc);  // También se puede atrapar como bad_alloc
+    EXPECT_EQ(runtime.getFailedAllocations(), failedBefore + 2);
+    runtime.setHeapLimit(0);
+}
+
+//Los bloques de las regiones y de la política contada también cuentan para el límite, y una reserva
+//rechazada no suma bytes a los umbrales de recolección del GC
+TEST(MPointerRuntimeTest, RegionAndCountedBlocksAreCharged) {
+    MPointerRuntime& runtime = MPointerRuntime::getInstance();
+    runtime.collectAll();  // La basura que dejaron otras pruebas no cuenta para el límite
+    runtime.setHeapLimit(runtime.getLiveBytes() + 64 * 1024);
+    {
+        MPointerScope scope;
+        EXPECT_THROW(scope.allocate(1 << 20, 16), MPointerHeapLimitExceeded);
+    }
+
+    std::vector<MPointer<LimitedNode, MPointerAtomicPolicy>> counted;
+    EXPECT_THROW({
+        for (int i = 0; i < 100; i++) {
+            counted.push_back(MPointer<LimitedNode, MPointerAtomicPolicy>::New());
+        }
+    }, MPointerHeapLimitExceeded);
+    EXPECT_LT(counted.size(), 64u);
+    counted.clear();  // Los bloques contados se devuelven al soltar la última referencia
+
+    std::vector<MPointer<LimitedNode>> live;
+    MPointerGC<LimitedNode>* gc = MPointerGC<LimitedNode>::getInstance();
+    EXPECT_THROW({
+        for (int i = 0; i < 100; i++) {
+            live.push_back(MPointer<LimitedNode>::New());
+        }
+    }, MPointerHeapLimitExceeded);
+    size_t bytesBefore = gc->getBytesSinceCollection();
+    EXPECT_THROW(MPointer<LimitedNode>::New(), MPointerHeapLimitExceeded);
+    EXPECT_LE(gc->getBytesSinceCollection(), bytesBefore);
+    runtime.setHeapLimit(0);
+}
+
+//Con la política Block la reserva espera a que otro hilo suelte memoria
+TEST(MPointerRuntimeTest, BlockWaitsForReleasedMemory) {
+    MPointerRuntime& runtime = MPointerRuntime::getInstance();
+    std::vector<MPointer<LimitedNode>> live;
+    runtime.collectAll();  // La basura que dejaron otras pruebas no cuenta para el límite
+    runtime.setHeapLimit(runtime.getLiveBytes() + 20 * sizeof(LimitedNode),
+                         MPointerRuntime::LimitPolicy::Block, std::chrono::milliseconds(5000));
+    for (int i = 0; i < 20; i++) {
+        live.push_back(MPointer<LimitedNode>::New());
+    }
+    size_t blockedBefore = runtime.getBlockedMicros();
+    std::thread releaser([&live]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        live.pop_back();  // El GC lo libera en su próximo ciclo y despierta al que espera
+    });
+    EXPECT_NO_THROW(MPointer<LimitedNode>::New());
+    releaser.join();
+    EXPECT_GT(runtime.getBlockedMicros(), blockedBefore);
+    runtime.setHeapLimit(0);
+}
+
+///////////////////////////////////////////////////////MPointerSnapshot/////////////////////////////////////////////////
+// Tipo auxiliar con un MPointer interno (arista conocida para el snapshot)
+struct SnapshotNode {
+    int value = 0;
+    MPointer<SnapshotNode> child = nullptr;
+};
+
+template <>
+struct MPointerSnapshotEdges<SnapshotNode> {
+    static constexpr bool known = true;
+    template <typename Visit>
+    static void forEach(const SnapshotNode& node, Visit visit) {
+        visit(node.child);
+    }
+};
+
+//El snapshot guarda objetos, refCounts y aristas; el análisis calcula lo retenido y encuentra los ciclos sin raíz
+TEST(MPointerSnapshotTest, CapturesObjectsEdgesAndRetainedSizes) {
+    MPointerGC<SnapshotNode>* gc = MPointerGC<SnapshotNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    MPointer<SnapshotNode> root = MPointer<SnapshotNode>::New();
+    {
+        MPointer<SnapshotNode> middle = MPointer<SnapshotNode>::New();
+        root->child = middle;
+        middle->child = MPointer<SnapshotNode>::New();
+        // Ciclo que ya nadie más referencia: el refCount nunca llega a 0
+        MPointer<SnapshotNode> first = MPointer<SnapshotNode>::New();
+        MPointer<SnapshotNode> second = MPointer<SnapshotNode>::New();
+        first->child = second;
+        second->child = first;
+    }
+    gc->collect();
+
+    MPointerHeapSnapshot snapshot;
+    gc->snapshot(snapshot);
+    ASSERT_EQ(snapshot.types.size(), 1u);
+    EXPECT_TRUE(snapshot.types[0].edgesKnown);
+    EXPECT_EQ(snapshot.types[0].size, sizeof(SnapshotNode));
+    ASSERT_EQ(snapshot.objects.size(), 5u);
+    EXPECT_EQ(snapshot.edges.size(), 4u);
+
+    std::string path = testing::TempDir() + "mpointer_heap.snapshot";
+    snapshot.write(path);
+    MPointerHeapSnapshot loaded = MPointerHeapSnapshot::read(path);
+    ASSERT_EQ(loaded.objects.size(), snapshot.objects.size());
+    EXPECT_EQ(loaded.edges.size(), snapshot.edges.size());
+    EXPECT_EQ(loaded.types[0].name, snapshot.types[0].name);
+
+    std::vector<bool> unreachable;
+    std::vector<uint64_t> retained = loaded.retainedSizes(&unreachable);
+    size_t cycles = 0;
+    for (size_t i = 0; i < loaded.objects.size(); i++) {
+        if (loaded.objects[i].id == root.getId()) {
+            EXPECT_EQ(loaded.objects[i].refCount, 1);
+            EXPECT_EQ(retained[i], 3 * sizeof(SnapshotNode));  // root -> middle -> hoja
+            EXPECT_FALSE(unreachable[i]);
+        }
+        cycles += unreachable[i] ? 1 : 0;
+    }
+    EXPECT_EQ(cycles, 2u);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+//Un snapshot con índices de tipo fuera de la tabla se rechaza al leerlo
+TEST(MPointerSnapshotTest, ReadRejectsUnknownTypes) {
+    MPointerHeapSnapshot snapshot;
+    snapshot.types.push_back({"SnapshotNode", sizeof(SnapshotNode), true});
+    snapshot.objects.push_back({0x1000, sizeof(SnapshotNode), 1, 1, 0, 0});
+    std::string path = testing::TempDir() + "mpointer_invalid.snapshot";
+
+    snapshot.objects.push_back({0x2000, sizeof(SnapshotNode), 2, 1, 3, 0});
+    snapshot.write(path);
+    EXPECT_THROW(MPointerHeapSnapshot::read(path), std::runtime_error);
+
+    snapshot.objects.pop_back();
+    snapshot.edges.push_back({1, 1, 0, 7, 0});
+    snapshot.write(path);
+    EXPECT_THROW(MPointerHeapSnapshot::read(path), std::runtime_error);
+
+    snapshot.edges.back().toType = 0;
+    snapshot.write(path);
+    EXPECT_EQ(MPointerHeapSnapshot::read(path).edges.size(), 1u);
+    std::remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////MPointerProfiler/////////////////////////////////////////////////
+// Tipo auxiliar de 64 bytes para el profiler de reservas
+struct ProfiledNode {
+    char payload[64] = {};
+};
+
+//Con muestreo cada 64 bytes la estimación ponderada se acerca a la cantidad real de objetos creados
+TEST(MPointerProfilerTest, SampledSitesEstimateAllocations) {
+    MPointerGC<ProfiledNode>::getInstance()->setCollectionMode(CollectionMode::Immediate);
+    MPointerAllocationProfiler::reset();
+    MPointerAllocationProfiler::setSamplingInterval(64);
+    for (int i = 0; i < 2000; i++) {
+        MPointer<ProfiledNode>::New();
+    }
+    MPointerAllocationProfiler::setSamplingInterval(0);
+    MPointer<ProfiledNode>::New();  // Apagado: no cuenta
+
+    double objects = 0;
+    size_t samples = 0;
+    for (auto& site : MPointerAllocationProfiler::getSites()) {
+        std::string suffix = "MPointer<ProfiledNode>::New";
+        if (site.first.size() >= suffix.size() &&
+            site.first.compare(site.first.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            objects += site.second.objects;
+            samples += site.second.samples;
+        }
+    }
+    EXPECT_GT(samples, 0u);
+    EXPECT_LT(samples, 2000u);  // Es un muestreo, no una traza completa
+    EXPECT_NEAR(objects, 2000.0, 400.0);
+    MPointerAllocationProfiler::reset();
+    MPointerGC<ProfiledNode>::getInstance()->setCollectionMode(CollectionMode::Background);
+}
+
+//Una muestra de NewBlock pondera todos los objetos del bloque, no cuenta el bloque como un objeto
+TEST(MPointerProfilerTest, SampledBlocksCountEveryObject) {
+    MPointerGC<ProfiledNode>::getInstance()->setCollectionMode(CollectionMode::Immediate);
+    MPointerAllocationProfiler::reset();
+    MPointerAllocationProfiler::setSamplingInterval(4096);
+    for (int i = 0; i < 1000; i++) {
+        MPointer<ProfiledNode>::NewBlock(16);
+    }
+    MPointerAllocationProfiler::setSamplingInterval(0);
+
+    double objects = 0;
+    for (auto& site : MPointerAllocationProfiler::getSites()) {
+        objects += site.second.objects;
+    }
+    EXPECT_NEAR(objects, 16000.0, 3000.0);
+    MPointerAllocationProfiler::reset();
+    MPointerGC<ProfiledNode>::getInstance()->setCollectionMode(CollectionMode::Background);
+}
+
+///////////////////////////////////////////////////////MPointerRecorder////////////////////////////////////////////////
+// Tipo auxiliar para la grabación de reservas
+struct RecordedNode {
+    int value = 0;
+};
+
+//La grabación guarda New, cada copia y cada destrucción del objeto, y se vuelve a leer del archivo
+TEST(MPointerRecorderTest, RecordsNewCopyAndDestroy) {
+    MPointerGC<RecordedNode>* gc = MPointerGC<RecordedNode>::getInstance();
+    gc->setCollectionMode(CollectionMode::Manual);
+    std::string path = testing::TempDir() + "mpointer_recording.bin";
+    MPointer<RecordedNode> before = MPointer<RecordedNode>::New();  // Creado antes de grabar
+
+    MPointerAllocationRecorder::start(path);
+    EXPECT_TRUE(MPointerAllocationRecorder::recording());
+    int id;
+    {
+        MPointer<RecordedNode> first = MPointer<RecordedNode>::New();
+        id = first.getId();
+        MPointer<RecordedNode> second = first;
+        second = before;  // Suelta `first` y copia `before`
+    }
+    EXPECT_GT(MPointerAllocationRecorder::stop(), 0u);
+    EXPECT_FALSE(MPointerAllocationRecorder::recording());
+    MPointer<RecordedNode> after = MPointer<RecordedNode>::New();  // Ya no se graba
+
+    MPointerRecording recording = MPointerRecording::read(path);
+    recording.sortByTime();
+    std::vector<MPointerRecordEvent> events;
+    for (const MPointerRecordEvent& event : recording.events) {
+        ASSERT_LT(event.type, recording.types.size());
+        if (recording.types[event.type].name == "RecordedNode") {
+            EXPECT_EQ(recording.types[event.type].size, sizeof(RecordedNode));
+            events.push_back(event);
+        }
+    }
+    std::map<int, std::vector<MPointerRecordKind>> kinds;
+    for (const MPointerRecordEvent& event : events) {
+        kinds[event.object].push_back(event.kind());
+        EXPECT_EQ(event.thread, events.front().thread);
+    }
+    ASSERT_EQ(kinds.size(), 2u);
+    EXPECT_EQ(kinds[id].front(), MPointerRecordKind::New);
+    EXPECT_EQ(kinds[id].back(), MPointerRecordKind::Destroy);
+    long balance = 0;  // New y cada copia suman una referencia; cada destrucción resta una
+    for (MPointerRecordKind kind : kinds[id]) {
+        balance += kind == MPointerRecordKind::Destroy ? -1 : 1;
+    }
+    EXPECT_EQ(balance, 0);
+    std::vector<MPointerRecordKind> previous = {MPointerRecordKind::Copy, MPointerRecordKind::Destroy};
+    EXPECT_EQ(kinds[before.getId()], previous);  // La copia a `second` y su destrucción al salir del bloque
+    EXPECT_EQ(kinds.count(after.getId()), 0u);
+    gc->setCollectionMode(CollectionMode::Background);
+}
+
+///////////////////////////////////////////////////////MPointerScope////////////////////////////////////////////////////
+// Tipo auxiliar que cuenta cuántas veces se ejecuta su destructor
+struct ScopeCounted {
+    static inline int destroyed = 0;
+    int value = 0;
+    ~ScopeCounted() { ++destroyed; }
+};
+
+//Los objetos creados dentro de un scope viven en la región y no se registran en el GC
+TEST(MPointerScopeTest, NewInsideScopeUsesRegion) {
+    MPointerScope scope;
+    auto ptr = MPointer<int>::New();
+    *ptr = 7;
+
+    EXPECT_EQ(ptr.getId(), 0);  // ID reservado para objetos de región
+    EXPECT_EQ(*ptr, 7);
+    EXPECT_GE(scope.getBytesUsed(), sizeof(int));
+    EXPECT_EQ(MPointerScope::active(), &scope);
+}
+
+//Al salir del scope se ejecutan los destructores de T no trivial y el scope anterior vuelve a estar activo
+TEST(MPointerScopeTest, ScopeExitRunsDestructors) {
+    ScopeCounted::destroyed = 0;
+    {
+        MPointerScope scope;
+        for (int i = 0; i < 100; i++) {
+            auto ptr = MPointer<ScopeCounted>::New();
+            ptr->value = i;
+        }
+        EXPECT_EQ(ScopeCounted::destroyed, 0);  // Nada se destruye antes de salir del scope
+    }
+    EXPECT_EQ(ScopeCounted::destroyed, 100);
+    EXPECT_EQ(MPointerScope::active(), nullptr);
+}
+
+//Una lista doblemente enlazada completa puede vivir en la región
+TEST(MPointerScopeTest, DoublyLinkedListInsideScope) {
+    MPointerScope scope;
+    DoublyLinkedList<int> list;
+    for (int value : {5, 3, 9, 1}) {
+        list.append(value);
+    }
+    insertionSort(list);
+
+    EXPECT_EQ(list.size(), 4);
+    EXPECT_EQ(list.get(0), 1);
+    EXPECT_EQ(list.get(3), 9);
+}
+
+//Una reserva grande va a un bloque propio: las reservas chicas siguen en el mismo bloque, una al lado de la otra
+TEST(MPointerScopeTest, LargeAllocationKeepsCurrentBlock) {
+    MPointerScope scope;
+    char* first = static_cast<char*>(scope.allocate(16, 16));
+    void* large = scope.allocate(1 << 20, 64);
+    char* second = static_cast<char*>(scope.allocate(16, 16));
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0u);
+    EXPECT_EQ(second, first + 16);
+    EXPECT_GE(scope.getBytesUsed(), (1u << 20) + 32);
+}
+
+#ifndef NDEBUG
+//En debug, un MPointer que sobrevive a su región se detecta al cerrar el scope
+TEST(MPointerScopeDeathTest, EscapingHandleIsDetected) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH({
+        auto* escaped = new MPointer<int>();
+        {
+            MPointerScope scope;
+            *escaped = MPointer<int>::New();
+        }
+    }, "escaparon");
 }
+#endif
 
 //Main para hacer todas las pruebas a la vez
 int main(int argc, char **argv) {